@@ -0,0 +1,275 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_CALENDAREVENTQUEUE_H
+#define CS4328_PROJECT1_CALENDAREVENTQUEUE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "EventQueue.h"
+
+using std::vector;
+
+/**
+ * An event queue implemented as a calendar queue (R. Brown, 1988). Time is divided into "days" of a fixed width, and
+ * the calendar is an array of buckets, one per day of the "year", with each bucket holding the events that fall on
+ * that day in any year. Dequeuing walks through the days in order, so when the width matches the spacing of events (as
+ * it does for the roughly uniform event times of poisson workloads) scheduling and getting an event are O(1)
+ * amortized. The number of buckets and the day width are recalculated as the queue grows and shrinks.
+ */
+class CalendarEventQueue {
+
+public:
+    /**
+     * Creates an empty CalendarEventQueue.
+     * @param lazyCancellation If true, cancelled events are only marked as cancelled (tombstoned) and are skipped when
+     *        they come up, instead of being removed right away.
+     */
+    explicit CalendarEventQueue(bool lazyCancellation = false)
+            : buckets(MIN_BUCKETS), before(&handles.getSequences()) {
+        this->lazyCancellation = lazyCancellation;
+        this->width = 1;
+        this->currentDay = 0;
+        this->storedEvents = 0;
+        this->liveEvents = 0;
+    }
+
+    CalendarEventQueue(const CalendarEventQueue&) = delete;
+    CalendarEventQueue& operator=(const CalendarEventQueue&) = delete;
+
+    /**
+     * Creates an Event and adds it to the CalendarEventQueue.
+     * @param time The time the event occurs.
+     * @param type The type of the event.
+     * @param subject The process the event corresponds to (arrivals), or the CPU core it happens on (departures and
+     *        timeouts).
+     * @return A handle to the event, valid until the event is returned by getEvent() or cancelled.
+     */
+    EventHandle scheduleEvent(SimTime time, EventType type, unsigned subject = 0) {
+        EventHandle handle = handles.allocate();
+        insert(Event(time, type, subject, handle));
+        storedEvents++;
+        liveEvents++;
+        if (storedEvents > 2 * buckets.size())
+            resize(2 * buckets.size());
+        return handle;
+    }
+
+    /**
+     * Cancels (removes) a scheduled event from the CalendarEventQueue.
+     * @param handle The handle returned when the event was scheduled.
+     * @return True if the event was cancelled, false if the handle doesn't refer to a pending event.
+     */
+    bool cancelEvent(EventHandle handle) {
+        if (!handles.isPending(handle))
+            return false;
+
+        liveEvents--;
+        if (lazyCancellation) {
+            handles.tombstone(handle);
+        } else {
+            // Buckets are short, so finding the event within its bucket is cheap
+            vector<Event>& bucket = buckets[handles.location(handle)];
+            for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+                if (it->getHandle() == handle) {
+                    bucket.erase(it);
+                    break;
+                }
+            }
+            handles.release(handle);
+            storedEvents--;
+            shrinkIfSparse();
+        }
+        return true;
+    }
+
+    /**
+     * Gets the next event (the one with the soonest time) and removes it from the CalendarEventQueue.
+     * @return The next event.
+     */
+    Event getEvent() {
+        while (true) {
+            vector<Event>& bucket = buckets[nextBucket()];
+            Event event = bucket.back();
+            bucket.pop_back();
+            storedEvents--;
+            bool cancelled = handles.isTombstone(event.getHandle());
+            handles.release(event.getHandle());
+
+            if (!cancelled) {
+                liveEvents--;
+                shrinkIfSparse();
+                return event;
+            }
+        }
+    }
+
+    /**
+     * Returns the time of the next event (the one with the soonest time) without removing it. Must not be called on an
+     * empty CalendarEventQueue.
+     * @return The time (in seconds) of the next event.
+     */
+    SimTime nextTime() {
+        while (true) {
+            vector<Event>& bucket = buckets[nextBucket()];
+            const Event& event = bucket.back();
+            if (!handles.isTombstone(event.getHandle()))
+                return event.getTime();
+
+            // Drop the tombstone, as getEvent() would
+            handles.release(event.getHandle());
+            bucket.pop_back();
+            storedEvents--;
+        }
+    }
+
+    /**
+     * Returns the number of events in the CalendarEventQueue (not counting cancelled ones).
+     * @return The number of events scheduled.
+     */
+    size_t size() {
+        return handles.countPending();
+    }
+
+    /**
+     * Determines whether or not the CalendarEventQueue is empty.
+     * @return True if the CalendarEventQueue is empty (has no events), false otherwise.
+     */
+    bool empty() {
+        return liveEvents == 0;
+    }
+
+    /**
+     * Returns every pending event (not counting cancelled ones) in the order they will be handled.
+     * Scheduling them again in this order, into an empty event queue, gives an equivalent queue.
+     * @return The pending events, soonest first.
+     */
+    vector<Event> pendingEvents() {
+        vector<Event> pending;
+        for (const auto& bucket : buckets)
+            for (const Event& e : bucket)
+                if (!handles.isTombstone(e.getHandle()))
+                    pending.push_back(e);
+        std::sort(pending.begin(), pending.end(), before);
+        return pending;
+    }
+
+private:
+    static const size_t MIN_BUCKETS = 2;
+
+    // Each bucket is sorted with its soonest event at the back
+    vector<vector<Event>> buckets;
+    EventHandleTable<size_t> handles;
+    EventOrder before;
+    bool lazyCancellation;
+
+    // The width (in seconds, or whole ticks with the tick clock) of a day, and the day (counted from time 0) the
+    // calendar is currently on
+    SimTime width;
+    long long currentDay;
+
+    // Number of events in the buckets (including tombstones), and number of events that haven't been cancelled
+    size_t storedEvents;
+    size_t liveEvents;
+
+    /**
+     * Determines which day (counted from time 0) a time falls on.
+     * @param time The time (in seconds).
+     * @return The day the time falls on.
+     */
+    long long dayOf(SimTime time) {
+        if constexpr (TICK_CLOCK)
+            return time / width;
+        else
+            return (long long) std::floor(time / width);
+    }
+
+    /**
+     * Puts an event in its bucket, keeping the bucket sorted.
+     * @param e The event to insert.
+     */
+    void insert(const Event& e) {
+        long long day = dayOf(e.getTime());
+        if (day < currentDay) currentDay = day;
+
+        size_t index = (size_t) day & (buckets.size() - 1);
+        vector<Event>& bucket = buckets[index];
+        auto position = std::upper_bound(bucket.begin(), bucket.end(), e,
+                                         [this](const Event& a, const Event& b) { return before(b, a); });
+        bucket.insert(position, e);
+        handles.location(e.getHandle()) = index;
+    }
+
+    /**
+     * Advances the calendar to the bucket holding the soonest event. Must not be called on an empty calendar.
+     * @return The index of the bucket holding the soonest event.
+     */
+    size_t nextBucket() {
+        // Walk through one year of days looking for an event on the current day
+        for (size_t i = 0; i < buckets.size(); i++) {
+            size_t index = (size_t) currentDay & (buckets.size() - 1);
+            if (!buckets[index].empty() && dayOf(buckets[index].back().getTime()) == currentDay)
+                return index;
+            currentDay++;
+        }
+
+        // Nothing within a year, so jump straight to the soonest event
+        size_t best = buckets.size();
+        for (size_t index = 0; index < buckets.size(); index++) {
+            if (buckets[index].empty()) continue;
+            if (best == buckets.size() || before(buckets[index].back(), buckets[best].back()))
+                best = index;
+        }
+        currentDay = dayOf(buckets[best].back().getTime());
+        return best;
+    }
+
+    /**
+     * Halves the number of buckets when the calendar has become sparse.
+     */
+    void shrinkIfSparse() {
+        if (buckets.size() > MIN_BUCKETS && storedEvents < buckets.size() / 2)
+            resize(buckets.size() / 2);
+    }
+
+    /**
+     * Rebuilds the calendar with a new number of buckets and a day width estimated from the soonest events. Tombstones
+     * are dropped along the way.
+     * @param numBuckets The new number of buckets (a power of two).
+     */
+    void resize(size_t numBuckets) {
+        vector<Event> events;
+        events.reserve(storedEvents);
+        for (auto& bucket : buckets) {
+            for (auto& e : bucket) {
+                if (handles.isTombstone(e.getHandle()))
+                    handles.release(e.getHandle());
+                else
+                    events.push_back(e);
+            }
+        }
+
+        // A day should hold a few events: use three times the average separation of the soonest events
+        size_t sample = std::min<size_t>(events.size(), 25);
+        if (sample >= 2) {
+            std::partial_sort(events.begin(), events.begin() + sample, events.end(), before);
+            SimTime separation = (events[sample - 1].getTime() - events[0].getTime()) / (SimTime) (sample - 1);
+            if (separation > 0)
+                width = 3 * separation;
+        }
+
+        buckets.assign(numBuckets, vector<Event>());
+        storedEvents = events.size();
+        currentDay = events.empty() ? 0 : dayOf(std::min_element(events.begin(), events.end(), before)->getTime());
+        for (auto& e : events)
+            insert(e);
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_CALENDAREVENTQUEUE_H
@@ -0,0 +1,246 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_CHECKPOINT_H
+#define CS4328_PROJECT1_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "SimTime.h"
+
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+/**
+ * The header at the start of a checkpoint file, followed by `payloadSize` bytes of state written by a
+ * CheckpointWriter. All values are stored in the machine's native byte order.
+ */
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    // Whether times are ticks, and how many ticks make a second (see SimTime.h)
+    uint32_t tickClock;
+    double ticksPerSecond;
+    // Which scheduler the state is for (see Simulation::POLICY_FINGERPRINT)
+    uint32_t policy;
+    uint32_t reserved;
+    uint64_t payloadSize;
+    // FNV-1a hash of the payload, so a damaged checkpoint is never resumed
+    uint64_t checksum;
+};
+
+const char CHECKPOINT_MAGIC[8] {'S', 'C', 'H', 'C', 'K', 'P', 'N', 'T'};
+const uint32_t CHECKPOINT_VERSION = 1;
+
+/**
+ * Hashes bytes with 64-bit FNV-1a.
+ * @param data The bytes.
+ * @param size The number of bytes.
+ * @return The hash.
+ */
+inline uint64_t checkpointChecksum(const char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/**
+ * Builds the state of a simulation in memory, value by value, and saves it to a checkpoint file. Values are written
+ * as their raw bytes, so only plain values (and vectors of them) can be written.
+ */
+class CheckpointWriter {
+
+public:
+
+    /**
+     * Appends a plain value.
+     * @param value The value.
+     */
+    template <class T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be checkpointed");
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        payload.insert(payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    /**
+     * Appends a vector of plain values, preceded by its length.
+     * @param values The values.
+     */
+    template <class T>
+    void putVector(const vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be checkpointed");
+        put((uint64_t) values.size());
+        const char* bytes = reinterpret_cast<const char*>(values.data());
+        payload.insert(payload.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    /**
+     * Saves the state written so far to a checkpoint file. The file is written under a temporary name and then renamed,
+     * so a checkpoint being resumed is never seen half written.
+     * @param path The path of the checkpoint file.
+     * @param policy Which scheduler the state is for.
+     * @throws runtime_error If the file can't be written.
+     */
+    void save(const string& path, uint32_t policy) const {
+        CheckpointHeader header {};
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header.version = CHECKPOINT_VERSION;
+        header.tickClock = TICK_CLOCK;
+        header.ticksPerSecond = TICKS_PER_SECOND;
+        header.policy = policy;
+        header.payloadSize = payload.size();
+        header.checksum = checkpointChecksum(payload.data(), payload.size());
+
+        string temporary = path + ".tmp";
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (file == nullptr)
+            throw runtime_error("Can't create checkpoint \"" + path + "\"");
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1
+                       && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+        if (fclose(file) != 0 || !written || rename(temporary.c_str(), path.c_str()) != 0) {
+            remove(temporary.c_str());
+            throw runtime_error("Error writing checkpoint \"" + path + "\"");
+        }
+    }
+
+private:
+    vector<char> payload;
+
+};
+
+/**
+ * Reads the state of a simulation back from a checkpoint file, value by value in the order it was written.
+ */
+class CheckpointReader {
+
+public:
+
+    /**
+     * Reads a checkpoint file into memory and checks it.
+     * @param path The path of the checkpoint file.
+     * @throws runtime_error If the file can't be read, isn't a checkpoint, is damaged, or was saved with a different
+     * clock.
+     */
+    explicit CheckpointReader(const string& path) {
+        this->path = path;
+        this->position = 0;
+
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            throw runtime_error("Can't open checkpoint \"" + path + "\"");
+        bool valid = fread(&header, sizeof(header), 1, file) == 1
+                     && memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0
+                     && header.version == CHECKPOINT_VERSION && header.payloadSize < ((uint64_t) 1 << 40u);
+        if (valid) {
+            payload.resize(header.payloadSize);
+            valid = fread(payload.data(), 1, payload.size(), file) == payload.size()
+                    && fgetc(file) == EOF
+                    && checkpointChecksum(payload.data(), payload.size()) == header.checksum;
+        }
+        fclose(file);
+        if (!valid)
+            throw runtime_error("\"" + path + "\" is not a valid checkpoint");
+        if (header.tickClock != TICK_CLOCK || header.ticksPerSecond != TICKS_PER_SECOND)
+            throw runtime_error("\"" + path + "\" was saved by a simulator with a different clock");
+    }
+
+    /**
+     * Returns which scheduler the checkpoint's state is for.
+     * @return The scheduler's fingerprint.
+     */
+    uint32_t getPolicy() const { return this->header.policy; }
+
+    /**
+     * Reads the next plain value.
+     * @return The value.
+     * @throws runtime_error If the checkpoint has run out of values.
+     */
+    template <class T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be checkpointed");
+        T value;
+        memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    /**
+     * Reads the next vector of plain values.
+     * @param values Set to the values.
+     * @throws runtime_error If the checkpoint has run out of values.
+     */
+    template <class T>
+    void getVector(vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be checkpointed");
+        uint64_t count = get<uint64_t>();
+        if (count > (payload.size() - position) / sizeof(T))
+            fail();
+        values.resize(count);
+        memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+
+    /**
+     * Reads the next count, checking it is no more than a limit.
+     * @param max The largest count allowed.
+     * @return The count.
+     * @throws runtime_error If the count is larger than the limit, or the checkpoint has run out of values.
+     */
+    uint64_t getCount(uint64_t max) {
+        uint64_t count = get<uint64_t>();
+        if (count > max)
+            fail();
+        return count;
+    }
+
+    /**
+     * Checks that every value has been read.
+     * @throws runtime_error If values are left over.
+     */
+    void finish() {
+        if (position != payload.size())
+            fail();
+    }
+
+    /**
+     * Reports a checkpoint whose values don't make sense.
+     * @throws runtime_error Always.
+     */
+    [[noreturn]] void fail() {
+        throw runtime_error("Checkpoint \"" + path + "\" is inconsistent");
+    }
+
+private:
+    string path;
+    CheckpointHeader header {};
+    vector<char> payload;
+    size_t position;
+
+    /**
+     * Takes the next bytes of the payload.
+     * @param size The number of bytes.
+     * @return The bytes.
+     * @throws runtime_error If fewer bytes are left.
+     */
+    const char* take(size_t size) {
+        if (size > payload.size() - position)
+            fail();
+        const char* bytes = payload.data() + position;
+        position += size;
+        return bytes;
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_CHECKPOINT_H
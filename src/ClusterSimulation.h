@@ -0,0 +1,414 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_CLUSTERSIMULATION_H
+#define CS4328_PROJECT1_CLUSTERSIMULATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+using std::pair;
+using std::set;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * How the dispatcher of a cluster model picks the cluster for each arriving process.
+ * Round robin: clusters take turns, regardless of their load.
+ * Least loaded: the cluster with the fewest processes that haven't departed yet, as far as the dispatcher knows.
+ * Clusters report each departure back to the dispatcher, which hears of it after the dispatch delay.
+ */
+enum RoutingPolicy {
+    ROUND_ROBIN_ROUTING, LEAST_LOADED_ROUTING
+};
+
+/**
+ * The parameters of a cluster model, on top of the SimulationConfig every cluster shares.
+ */
+struct ClusterConfig {
+    // The number of clusters (each with SimulationConfig::numCores cores)
+    unsigned numClusters = 1;
+    // The time (in seconds) for a process to travel from the dispatcher to a cluster, and for a departure report to
+    // travel back. It is the lookahead that lets clusters run in parallel, so least loaded routing needs it to be > 0.
+    double dispatchDelay = 0;
+    RoutingPolicy routing = ROUND_ROBIN_ROUTING;
+    // The number of threads to run the clusters on (0 to use one per hardware thread, 1 to run them in turn)
+    unsigned numThreads = 0;
+    // The most processes dispatched per cluster in one window, which bounds the messages held between windows
+    size_t windowArrivals = 4096;
+};
+
+/**
+ * A process on its way from the dispatcher to a cluster.
+ */
+struct Dispatch {
+    SimTime arrivalTime;
+    int id;
+    SimTime serviceTime;
+};
+
+/**
+ * The logical process that generates the workload of a cluster model and routes each arriving process to a cluster.
+ * It has its own event queue holding the next arrival and the departure reports on their way back from the clusters.
+ * @tparam EventQueueType The event queue implementation to use.
+ * @tparam Workload The source of the processes.
+ */
+template <class EventQueueType, class Workload>
+class Dispatcher {
+
+public:
+
+    /**
+     * Creates a Dispatcher, scheduling the first process' arrival.
+     * @param cluster The parameters of the cluster model.
+     * @param workload The source of the processes.
+     */
+    Dispatcher(const ClusterConfig& cluster, Workload& workload)
+            : cluster(cluster), workload(workload), outstanding(cluster.numClusters, 0) {
+        this->dispatchDelay = toSimTime(cluster.dispatchDelay);
+        this->processesCreated = 0;
+        this->nextCluster = 0;
+        this->pendingArrival = false;
+        if (cluster.routing == LEAST_LOADED_ROUTING)
+            for (unsigned c = 0; c < cluster.numClusters; c++)
+                loads.insert({0, c});
+
+        // The first process arrives at time 0, whatever its inter-arrival time
+        scheduleNextArrival(0, true);
+    }
+
+    /**
+     * Handles every event before a time, stopping early once enough processes have been dispatched.
+     * @param endTime The time (in seconds) to handle events up to (exclusive).
+     * @param maxDispatches The most processes to dispatch.
+     * @param outboxes The processes dispatched to each cluster are appended to its outbox, in order of arrival.
+     * @return The time events were handled up to: endTime, or the time of the next event if stopped early.
+     */
+    SimTime runUntil(SimTime endTime, size_t maxDispatches, vector<vector<Dispatch>>& outboxes) {
+        size_t dispatched = 0;
+        while (!eventQueue.empty() && eventQueue.nextTime() < endTime) {
+            if (dispatched == maxDispatches)
+                return eventQueue.nextTime();
+
+            Event current = eventQueue.getEvent();
+            if (current.getType() == ARRIVAL) {
+                // Route the arriving process, then schedule the next one
+                unsigned c = route();
+                outboxes[c].push_back({current.getTime() + dispatchDelay, processesCreated - 1,
+                                       pendingServiceTime});
+                dispatched++;
+                scheduleNextArrival(current.getTime(), false);
+            } else if (current.getType() == DEPARTURE) {
+                // A departure report from the cluster the event is for
+                setLoad(current.getCore(), outstanding[current.getCore()] - 1);
+            }
+        }
+        return endTime;
+    }
+
+    /**
+     * Schedules the report of a departure from a cluster.
+     * @param time The time (in seconds) the report reaches the dispatcher.
+     * @param c The cluster the process departed from.
+     */
+    void reportDeparture(SimTime time, unsigned c) {
+        eventQueue.scheduleEvent(time, DEPARTURE, c);
+    }
+
+    /**
+     * Returns the time of the next event.
+     * @return The time (in seconds) of the next event, or NEVER if there is none.
+     */
+    SimTime nextEventTime() {
+        return eventQueue.empty() ? NEVER : eventQueue.nextTime();
+    }
+
+    /**
+     * Determines whether every process has been dispatched.
+     * @return True if no more processes will arrive.
+     */
+    bool exhausted() const { return !this->pendingArrival; }
+
+    /**
+     * Returns the number of processes created so far (including the one waiting to arrive, if any).
+     * @return The number of processes created.
+     */
+    int getProcessesCreated() const { return this->processesCreated; }
+
+private:
+    ClusterConfig cluster;
+    SimTime dispatchDelay;
+    EventQueueType eventQueue;
+    Workload& workload;
+
+    int processesCreated;
+
+    // The service time of the process waiting to arrive, if there is one
+    bool pendingArrival;
+    SimTime pendingServiceTime;
+
+    // Round robin: the cluster next in turn. Least loaded: the processes each cluster has yet to finish, and
+    // (processes, cluster) of every cluster in order of load
+    unsigned nextCluster;
+    vector<long> outstanding;
+    set<pair<long, unsigned>> loads;
+
+    /**
+     * Draws the next process from the workload (unless it has run out) and schedules its arrival.
+     * @param lastArrivalTime The arrival time (in seconds) of the previous process.
+     * @param first Whether this is the first process, which arrives at time 0.
+     */
+    void scheduleNextArrival(SimTime lastArrivalTime, bool first) {
+        double interArrivalTime, serviceTime;
+        pendingArrival = workload.next(interArrivalTime, serviceTime);
+        if (!pendingArrival) return;
+
+        pendingServiceTime = toServiceTime(serviceTime);
+        processesCreated++;
+        eventQueue.scheduleEvent(first ? 0 : lastArrivalTime + toSimTime(interArrivalTime), ARRIVAL);
+    }
+
+    /**
+     * Picks the cluster for an arriving process.
+     * @return The cluster.
+     */
+    unsigned route() {
+        if (cluster.routing == ROUND_ROBIN_ROUTING) {
+            unsigned c = nextCluster;
+            nextCluster = (nextCluster + 1) % cluster.numClusters;
+            return c;
+        }
+        unsigned c = loads.begin()->second;
+        setLoad(c, outstanding[c] + 1);
+        return c;
+    }
+
+    /**
+     * Changes the number of processes a cluster has yet to finish (least loaded routing only).
+     * @param c The cluster.
+     * @param load The new number of processes.
+     */
+    void setLoad(unsigned c, long load) {
+        loads.erase({outstanding[c], c});
+        outstanding[c] = load;
+        loads.insert({load, c});
+    }
+
+};
+
+/**
+ * Simulates a model of several clusters, each a multi-core machine, fed by a dispatcher that routes every arriving
+ * process to one of them. The model is partitioned into logical processes that each have their own event queue: the
+ * dispatcher, and one Simulation per cluster. They only interact through timestamped messages (dispatched processes,
+ * and departure reports with least loaded routing) that take the dispatch delay to arrive.
+ *
+ * The logical processes are synchronized conservatively in windows, as in YAWNS. Each window starts at the soonest
+ * pending event of any logical process, T, and ends at T plus the lookahead: the dispatch delay with least loaded
+ * routing, or without limit with round robin routing (since clusters send nothing back). The dispatcher handles its
+ * events in the window first, so every process dispatched into the window is delivered before the clusters handle
+ * theirs, in parallel on a thread pool. Departure reports sent in the window can't reach the dispatcher before its end,
+ * so they are delivered at the barrier. A window also ends early once the dispatcher has dispatched windowArrivals
+ * processes per cluster, to bound the messages held at once.
+ *
+ * Messages are always delivered in the same order (the order sent, cluster by cluster), so the results are exactly the
+ * same no matter how many threads are used, including one, which runs the clusters in turn. With one cluster and no
+ * dispatch delay, the model is the same as a plain Simulation of the same processes.
+ *
+ * The model runs until config.numProcesses processes have departed from the clusters between them, or every process
+ * of the workload has, exactly as a Simulation runs. A window that might complete them is handled one event at a time
+ * in time order across the clusters instead, so the run stops right after the departure that does. The statistics
+ * cover all the clusters from time 0 to the last event any of them handled.
+ * @tparam Policy The SchedulingPolicy every cluster uses.
+ * @tparam EventQueueType The event queue implementation every logical process uses.
+ * @tparam Workload The source of the processes.
+ */
+template <class Policy, class EventQueueType, class Workload>
+class ClusterSimulation {
+
+public:
+
+    /**
+     * Sets up a cluster model.
+     * @param config The parameters every cluster shares, and the number of processes to simulate.
+     * @param cluster The parameters of the cluster model.
+     * @param workload The source of the processes.
+     */
+    ClusterSimulation(const SimulationConfig& config, const ClusterConfig& cluster, Workload& workload)
+            : config(config), cluster(cluster), dispatcher(cluster, workload),
+              outboxes(cluster.numClusters), departureLogs(cluster.numClusters) {
+        for (unsigned c = 0; c < cluster.numClusters; c++) {
+            clusters.emplace_back(new Simulation<Policy, EventQueueType, ExternalWorkload>(config, external));
+            if (cluster.routing == LEAST_LOADED_ROUTING)
+                clusters.back()->setDepartureLog(&departureLogs[c]);
+        }
+    }
+
+    /**
+     * Runs the model until the configured number of processes have departed, or every process of the workload has.
+     * @return The statistics of all the clusters combined.
+     */
+    Statistics run() {
+        unique_ptr<ThreadPool> pool;
+        if (cluster.numThreads != 1 && cluster.numClusters > 1)
+            pool.reset(new ThreadPool(cluster.numThreads));
+
+        SimTime dispatchDelay = toSimTime(cluster.dispatchDelay);
+        SimTime lookahead = cluster.routing == LEAST_LOADED_ROUTING ? dispatchDelay : NEVER;
+        size_t maxDispatches = cluster.windowArrivals * cluster.numClusters;
+        int departed = 0;
+        SimTime endTime = 0;
+
+        while (departed < config.numProcesses
+               && !(dispatcher.exhausted() && departed == dispatcher.getProcessesCreated())) {
+            // The window starts at the soonest event of any logical process
+            SimTime start = dispatcher.nextEventTime();
+            for (auto& c : clusters)
+                start = std::min(start, c->nextEventTime());
+
+            // Dispatch first, so the clusters have every arrival in the window before they start
+            // (a window without end stays without end, as infinity would, with the tick clock too)
+            SimTime windowEnd = lookahead == NEVER || start == NEVER ? NEVER : start + lookahead;
+            SimTime end = dispatcher.runUntil(windowEnd, maxDispatches, outboxes);
+            bool lastWindow = end == NEVER && dispatcher.exhausted();
+
+            // No more processes can depart in the window than are in the clusters or dispatched into it
+            long mayDepart = 0;
+            for (size_t c = 0; c < clusters.size(); c++)
+                mayDepart += clusters[c]->getProcessesInSystem() + (long) outboxes[c].size();
+
+            if (departed + mayDepart < config.numProcesses) {
+                // Advance the clusters through the window, in parallel
+                auto advance = [this, end, lastWindow](size_t c) {
+                    deliver(c);
+                    if (lastWindow)
+                        clusters[c]->drain();
+                    else
+                        clusters[c]->runUntil(end);
+                };
+                if (pool) {
+                    for (size_t c = 0; c < clusters.size(); c++)
+                        pool->submit([&advance, c] { advance(c); });
+                    pool->wait();
+                } else {
+                    for (size_t c = 0; c < clusters.size(); c++)
+                        advance(c);
+                }
+            } else {
+                // The window may complete the run, so it is handled in time order to stop at the right departure
+                for (size_t c = 0; c < clusters.size(); c++)
+                    deliver(c);
+                runInTimeOrder(end, lastWindow, departed);
+            }
+
+            // Barrier: count departures and send their reports back to the dispatcher, cluster by cluster
+            departed = 0;
+            for (size_t c = 0; c < clusters.size(); c++) {
+                departed += clusters[c]->getProcessesSimulated();
+                endTime = std::max(endTime, clusters[c]->getTime());
+                for (SimTime t : departureLogs[c])
+                    dispatcher.reportDeparture(t + dispatchDelay, (unsigned) c);
+            }
+        }
+
+        StatisticsAccumulator totals;
+        for (auto& c : clusters)
+            c->collectStatistics(totals, endTime);
+        return totals.finish(0, toSeconds(endTime), config.queryInterval);
+    }
+
+private:
+    SimulationConfig config;
+    ClusterConfig cluster;
+
+    Dispatcher<EventQueueType, Workload> dispatcher;
+    ExternalWorkload external;
+    vector<unique_ptr<Simulation<Policy, EventQueueType, ExternalWorkload>>> clusters;
+
+    // Messages in flight: processes dispatched to each cluster, and each cluster's departures (least loaded only)
+    vector<vector<Dispatch>> outboxes;
+    vector<vector<SimTime>> departureLogs;
+
+    /**
+     * Delivers the processes dispatched to a cluster for the coming window, and clears its departure log.
+     * @param c The cluster.
+     */
+    void deliver(size_t c) {
+        for (auto& d : outboxes[c])
+            clusters[c]->injectArrival(d.arrivalTime, d.id, d.serviceTime);
+        outboxes[c].clear();
+        departureLogs[c].clear();
+    }
+
+    /**
+     * Handles the events of a window one at a time, in time order across the clusters (the lowest numbered cluster
+     * first on a tie), until the configured number of processes have departed.
+     * @param end The time (in seconds) the window ends (exclusive).
+     * @param lastWindow Whether no more processes will be dispatched, in which case each cluster only handles events
+     * until its processes have departed, as Simulation::drain() does.
+     * @param departed The number of processes that departed before the window.
+     */
+    void runInTimeOrder(SimTime end, bool lastWindow, int departed) {
+        // (next event time, cluster) of every cluster with events left to handle in the window
+        set<pair<SimTime, size_t>> pending;
+        auto schedule = [&](size_t c) {
+            SimTime next = clusters[c]->nextEventTime();
+            if (lastWindow ? clusters[c]->getProcessesInSystem() > 0 : next < end)
+                pending.insert({next, c});
+        };
+        for (size_t c = 0; c < clusters.size(); c++)
+            schedule(c);
+
+        while (departed < config.numProcesses && !pending.empty()) {
+            size_t c = pending.begin()->second;
+            pending.erase(pending.begin());
+            int before = clusters[c]->getProcessesSimulated();
+            clusters[c]->handleNextEvent();
+            departed += clusters[c]->getProcessesSimulated() - before;
+            schedule(c);
+        }
+    }
+
+};
+
+/**
+ * Simulates one of the available schedulers on a cluster model, replaying the configured trace file or, if there is
+ * none, generating processes from the random stream.
+ * @param backend The event queue implementation to use.
+ * @param scheduler The scheduler to simulate, numbered as on the command line (1-6).
+ * @param config The parameters every cluster shares, and the number of processes to simulate.
+ * @param cluster The parameters of the cluster model.
+ * @param rng The random stream to draw inter-arrival and service times from (unused when replaying a trace).
+ * @return The statistics of all the clusters combined.
+ * @throws runtime_error If the trace file can't be opened or isn't a valid trace.
+ */
+inline Statistics simulateClusters(EventQueueBackend backend, int scheduler, const SimulationConfig& config,
+                                   const ClusterConfig& cluster, RandomStream& rng) {
+    auto run = [&](auto& workload) {
+        return visitEventQueue(backend, [&](auto queue) {
+            return visitPolicy(scheduler, [&](auto policy) {
+                ClusterSimulation<typename decltype(policy)::type, typename decltype(queue)::type,
+                                  typename std::remove_reference<decltype(workload)>::type>
+                        simulation(config, cluster, workload);
+                return simulation.run();
+            });
+        });
+    };
+
+    if (!config.tracePath.empty()) {
+        TraceWorkload workload(config.tracePath);
+        return run(workload);
+    }
+    SyntheticWorkload workload(rng, config.arrivalRate, config.serviceTime);
+    return run(workload);
+}
+
+
+#endif //CS4328_PROJECT1_CLUSTERSIMULATION_H
@@ -0,0 +1,136 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_EVENTHANDLE_H
+#define CS4328_PROJECT1_EVENTHANDLE_H
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+/**
+ * A handle to an event scheduled in an EventQueue, used to cancel the event later without searching for it.
+ */
+typedef unsigned int EventHandle;
+
+/**
+ * A handle that doesn't refer to any event.
+ */
+const EventHandle NO_EVENT = ~0u;
+
+/**
+ * Bookkeeping shared by the event queue backends: hands out handles, remembers where each pending event is stored in
+ * the backend and the order events were scheduled in, and tracks events that were cancelled lazily (tombstoned). The
+ * schedule order only breaks ties between events at the same time, so it is kept here rather than in every event.
+ * @tparam Location The backend's way of locating an event (e.g. a set iterator or a heap index).
+ */
+template <class Location>
+class EventHandleTable {
+
+public:
+
+    /**
+     * Creates an empty EventHandleTable.
+     */
+    EventHandleTable() {
+        this->nextSequence = 0;
+        this->numPending = 0;
+    }
+
+    /**
+     * Gets an unused handle, reusing a freed one if possible, for an event being scheduled.
+     * @return An unused handle, marked as pending and numbered after every event scheduled before it.
+     */
+    EventHandle allocate() {
+        EventHandle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = (EventHandle) states.size();
+            states.push_back(FREE);
+            locations.emplace_back();
+            sequences.push_back(0);
+        }
+        states[handle] = PENDING;
+        sequences[handle] = nextSequence++;
+        numPending++;
+        return handle;
+    }
+
+    /**
+     * Releases a handle so it can be reused.
+     * @param handle The handle to release.
+     */
+    void release(EventHandle handle) {
+        if (states[handle] == PENDING) numPending--;
+        states[handle] = FREE;
+        freeHandles.push_back(handle);
+    }
+
+    /**
+     * Determines whether a handle refers to an event that is still scheduled (and not cancelled).
+     * @param handle The handle to check.
+     * @return True if the handle's event is pending, false otherwise.
+     */
+    bool isPending(EventHandle handle) {
+        return handle != NO_EVENT && handle < states.size() && states[handle] == PENDING;
+    }
+
+    /**
+     * Marks a pending event as cancelled, leaving it in the backend to be skipped later.
+     * @param handle The handle of the event.
+     */
+    void tombstone(EventHandle handle) {
+        states[handle] = CANCELLED;
+        numPending--;
+    }
+
+    /**
+     * Determines whether a handle's event was cancelled lazily.
+     * @param handle The handle to check.
+     * @return True if the event is a tombstone, false otherwise.
+     */
+    bool isTombstone(EventHandle handle) { return states[handle] == CANCELLED; }
+
+    /**
+     * Returns where the backend stores a handle's event.
+     * @param handle The handle of the event.
+     * @return A reference to the location of the event, which the backend can update.
+     */
+    Location& location(EventHandle handle) { return locations[handle]; }
+
+    /**
+     * Returns the schedule order of every handle's event, for ordering events scheduled at the same time.
+     * @return The sequence number of each handle's event, indexed by handle.
+     */
+    const vector<unsigned long>& getSequences() const { return sequences; }
+
+    /**
+     * Returns the number of events that are still scheduled (and not cancelled).
+     * @return The number of pending events.
+     */
+    size_t countPending() const { return numPending; }
+
+private:
+    /**
+     * The state of an event handle.
+     */
+    enum HandleState {
+        FREE, PENDING, CANCELLED
+    };
+
+    vector<Location> locations;
+    vector<HandleState> states;
+    vector<unsigned long> sequences;
+    vector<EventHandle> freeHandles;
+    unsigned long nextSequence;
+    size_t numPending;
+
+};
+
+
+#endif //CS4328_PROJECT1_EVENTHANDLE_H
@@ -0,0 +1,373 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_EVENTLOG_H
+#define CS4328_PROJECT1_EVENTLOG_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SimTime.h"
+
+using std::atomic;
+using std::ifstream;
+using std::ofstream;
+using std::runtime_error;
+using std::string;
+using std::thread;
+using std::vector;
+
+/**
+ * What happened to a process: it arrived, was dispatched to a core, was preempted (taken off its core before it
+ * departed, by a higher priority process or at the end of its quantum or slice), or departed.
+ */
+enum LogEventType : uint8_t {
+    LOG_ARRIVAL, LOG_DISPATCH, LOG_PREEMPTION, LOG_DEPARTURE
+};
+
+const char* const LOG_EVENT_NAMES[] {"arrival", "dispatch", "preemption", "departure"};
+
+// The core of an event that doesn't happen on one (an arrival)
+const unsigned NO_CORE = 0xffff;
+
+/**
+ * One event of the log as the simulation appends it.
+ */
+struct LogRecord {
+    SimTime time;
+    int32_t process;
+    uint16_t core;
+    LogEventType type;
+};
+
+/**
+ * One event of the log as read back: the time in ticks of the log (see EventLogReader::getTicksPerSecond()), and the
+ * core as a plain number, -1 for none.
+ */
+struct LogEntry {
+    int64_t ticks;
+    int32_t process;
+    int32_t core;
+    LogEventType type;
+};
+
+/**
+ * The header at the start of an event log file. It is followed by blocks of events, each a LogBlockHeader followed by
+ * `bytes` bytes of columns. All values are stored in the machine's native byte order.
+ */
+struct LogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    // The resolution of the logged times
+    double ticksPerSecond;
+};
+
+/**
+ * The header of one block of events. The block holds its events column by column: every event's type (a byte each),
+ * then core (plus one, so 0 is no core), then process ID (the zigzagged difference from the previous event's), then
+ * time (the difference from the previous event's, in ticks), each column after the first in variable length integers
+ * (LEB128). Differences start from 0 in every block, so each block can be decoded on its own.
+ */
+struct LogBlockHeader {
+    uint32_t count;
+    uint32_t bytes;
+};
+
+const char LOG_MAGIC[8] {'S', 'C', 'H', 'E', 'V', 'L', 'O', 'G'};
+const uint32_t LOG_VERSION = 1;
+
+/**
+ * A log of every arrival, dispatch, preemption and departure of a simulation, written to a binary file in the
+ * background. The simulation appends events to a lock-free single producer, single consumer ring buffer, which only
+ * takes a few stores per event; a writer thread takes them off the ring a block at a time, encodes each block
+ * column by column with the small differences between consecutive events in as few bytes as they need (about 5 bytes an
+ * event, against 16 in memory), and writes it. If the writer falls behind, the simulation waits for room in the ring
+ * rather than dropping events.
+ */
+class EventLog {
+
+public:
+
+    /**
+     * Creates a log file and starts the writer thread.
+     * @param path The path of the log file.
+     * @throws runtime_error If the file can't be created.
+     */
+    explicit EventLog(const string& path) : out(path, std::ios::binary | std::ios::trunc), ring(RING_SIZE) {
+        if (!out)
+            throw runtime_error("Can't create event log \"" + path + "\"");
+        this->path = path;
+        this->head = 0;
+        this->cachedTail = 0;
+        this->tail = 0;
+        this->stopping = false;
+        this->failed = false;
+        this->closed = false;
+
+        LogHeader header {};
+        memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+        header.version = LOG_VERSION;
+        header.ticksPerSecond = TICK_CLOCK ? TICKS_PER_SECOND : NANOSECONDS_PER_SECOND;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        writer = thread(&EventLog::writeBlocks, this);
+    }
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * Writes the rest of the log, if it hasn't been closed.
+     */
+    ~EventLog() {
+        if (!closed) {
+            try { close(); } catch (const runtime_error&) {}
+        }
+    }
+
+    /**
+     * Appends an event to the log. Called from the simulation's thread only.
+     * @param time The time of the event.
+     * @param process The ID of the process.
+     * @param core The core the event happened on, NO_CORE for none.
+     * @param type What happened.
+     */
+    void append(SimTime time, int process, unsigned core, LogEventType type) {
+        size_t h = head.load(std::memory_order_relaxed);
+        // Wait for the writer if the ring is full (checking where the writer is only when it looks full)
+        while (h - cachedTail == RING_SIZE) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == RING_SIZE)
+                std::this_thread::yield();
+        }
+        ring[h & (RING_SIZE - 1)] = LogRecord {time, process, (uint16_t) core, type};
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    /**
+     * Waits for the writer thread to write every event appended, and closes the file.
+     * @return The number of events written.
+     * @throws runtime_error If the file couldn't be written.
+     */
+    size_t close() {
+        closed = true;
+        stopping.store(true, std::memory_order_release);
+        writer.join();
+        out.close();
+        if (failed || !out)
+            throw runtime_error("Error writing event log \"" + path + "\"");
+        return head.load(std::memory_order_relaxed);
+    }
+
+private:
+    // The number of events the ring holds, and the most written in one block
+    static const size_t RING_SIZE = 1u << 16u;
+    static const size_t BLOCK_SIZE = 1u << 13u;
+    static constexpr double NANOSECONDS_PER_SECOND = 1e9;
+
+    string path;
+    ofstream out;
+    vector<LogRecord> ring;
+    // The producer's and consumer's positions in the ring (counting every event ever appended), on their own cache
+    // lines, and the producer's last look at the consumer's
+    alignas(64) atomic<size_t> head;
+    size_t cachedTail;
+    alignas(64) atomic<size_t> tail;
+    alignas(64) atomic<bool> stopping;
+    bool failed;
+    bool closed;
+    thread writer;
+
+    /**
+     * Converts a time to ticks of the log: the clock's own ticks, or the nearest nanosecond for a clock in seconds
+     * (which is never negative).
+     * @param time The time.
+     * @return The time in ticks.
+     */
+    static int64_t toTicks(SimTime time) {
+        if constexpr (TICK_CLOCK)
+            return (int64_t) time;
+        else
+            return (int64_t) (time * NANOSECONDS_PER_SECOND + 0.5);
+    }
+
+    /**
+     * Writes an unsigned variable length integer (LEB128), of at most 10 bytes.
+     * @param out Where to write the integer, moved past it.
+     * @param value The integer.
+     */
+    static void putVarint(uint8_t*& out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = (uint8_t) (value | 0x80);
+            value >>= 7u;
+        }
+        *out++ = (uint8_t) value;
+    }
+
+    /**
+     * The writer thread: writes blocks of events as they fill up, and the last partial block once the log is closed.
+     */
+    void writeBlocks() {
+        vector<uint8_t> bytes;
+        while (true) {
+            bool stop = stopping.load(std::memory_order_acquire);
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t available = head.load(std::memory_order_acquire) - t;
+            if (available >= BLOCK_SIZE || (stop && available > 0)) {
+                size_t count = std::min(available, BLOCK_SIZE);
+                encode(t, count, bytes);
+                tail.store(t + count, std::memory_order_release);
+                LogBlockHeader block {(uint32_t) count, (uint32_t) bytes.size()};
+                out.write(reinterpret_cast<const char*>(&block), sizeof(block));
+                out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize) bytes.size());
+                if (!out)
+                    failed = true;
+            } else if (stop) {
+                break;
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    }
+
+    /**
+     * Encodes events of the ring as the columns of a block.
+     * @param first The position of the first event.
+     * @param count The number of events.
+     * @param bytes The buffer to encode the columns into (cleared first).
+     */
+    void encode(size_t first, size_t count, vector<uint8_t>& bytes) {
+        // Room for the longest encoding: a byte of type, and up to 3, 5 and 10 bytes of core, process and time
+        bytes.resize(count * 19);
+        uint8_t* out = bytes.data();
+        for (size_t i = first; i < first + count; i++)
+            *out++ = ring[i & (RING_SIZE - 1)].type;
+        for (size_t i = first; i < first + count; i++)
+            putVarint(out, (ring[i & (RING_SIZE - 1)].core + 1u) & 0xffffu);
+        int64_t previousProcess = 0;
+        for (size_t i = first; i < first + count; i++) {
+            int64_t difference = ring[i & (RING_SIZE - 1)].process - previousProcess;
+            putVarint(out, ((uint64_t) difference << 1u) ^ (uint64_t) (difference >> 63));
+            previousProcess = ring[i & (RING_SIZE - 1)].process;
+        }
+        int64_t previousTicks = 0;
+        for (size_t i = first; i < first + count; i++) {
+            int64_t ticks = toTicks(ring[i & (RING_SIZE - 1)].time);
+            putVarint(out, (uint64_t) (ticks - previousTicks));
+            previousTicks = ticks;
+        }
+        bytes.resize((size_t) (out - bytes.data()));
+    }
+
+};
+
+/**
+ * Reads an event log written by EventLog, a block at a time.
+ */
+class EventLogReader {
+
+public:
+
+    /**
+     * Opens an event log.
+     * @param path The path of the event log.
+     * @throws runtime_error If the file can't be opened or isn't an event log.
+     */
+    explicit EventLogReader(const string& path) : in(path, std::ios::binary) {
+        if (!in)
+            throw runtime_error("Can't open event log \"" + path + "\"");
+        this->path = path;
+        LogHeader header {};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!in || memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0 || header.version != LOG_VERSION)
+            throw runtime_error("\"" + path + "\" is not a valid event log");
+        this->ticksPerSecond = header.ticksPerSecond;
+    }
+
+    /**
+     * Returns the resolution of the log's times.
+     * @return The number of ticks in a second.
+     */
+    double getTicksPerSecond() const { return this->ticksPerSecond; }
+
+    /**
+     * Reads the next block of events.
+     * @param entries The list to replace with the block's events.
+     * @return True if a block was read, false at the end of the log.
+     * @throws runtime_error If the block is cut short or corrupt.
+     */
+    bool nextBlock(vector<LogEntry>& entries) {
+        LogBlockHeader block {};
+        in.read(reinterpret_cast<char*>(&block), sizeof(block));
+        if (in.gcount() == 0)
+            return false;
+        bytes.resize(block.bytes);
+        in.read(reinterpret_cast<char*>(bytes.data()), (std::streamsize) bytes.size());
+        if (!in || block.count > block.bytes)
+            throw runtime_error("\"" + path + "\" is cut short or corrupt");
+
+        entries.resize(block.count);
+        size_t position = 0;
+        for (auto& e : entries) {
+            if (bytes[position] > LOG_DEPARTURE)
+                throw runtime_error("\"" + path + "\" is corrupt");
+            e.type = (LogEventType) bytes[position++];
+        }
+        for (auto& e : entries)
+            e.core = (int32_t) getVarint(position) - 1;
+        int64_t process = 0;
+        for (auto& e : entries) {
+            uint64_t zigzag = getVarint(position);
+            process += (int64_t) (zigzag >> 1u) ^ -(int64_t) (zigzag & 1u);
+            e.process = (int32_t) process;
+        }
+        int64_t ticks = 0;
+        for (auto& e : entries) {
+            ticks += (int64_t) getVarint(position);
+            e.ticks = ticks;
+        }
+        if (position != bytes.size())
+            throw runtime_error("\"" + path + "\" is corrupt");
+        return true;
+    }
+
+private:
+    string path;
+    ifstream in;
+    double ticksPerSecond;
+    vector<uint8_t> bytes;
+
+    /**
+     * Reads a variable length integer (LEB128) from the current block.
+     * @param position The position of the integer in the block, moved past it.
+     * @return The integer.
+     * @throws runtime_error If the integer runs past the end of the block.
+     */
+    uint64_t getVarint(size_t& position) {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (position == bytes.size())
+                throw runtime_error("\"" + path + "\" is corrupt");
+            uint8_t byte = bytes[position++];
+            value |= (uint64_t) (byte & 0x7fu) << shift;
+            if (byte < 0x80)
+                return value;
+        }
+        throw runtime_error("\"" + path + "\" is corrupt");
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_EVENTLOG_H
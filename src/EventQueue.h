@@ -6,10 +6,15 @@
 #ifndef CS4328_PROJECT1_EVENTQUEUE_H
 #define CS4328_PROJECT1_EVENTQUEUE_H
 
+#include <cstdint>
 #include <set>
+#include <type_traits>
+#include <vector>
 #include "Process.h"
+#include "EventHandle.h"
 
 using std::set;
+using std::vector;
 
 /**
  * Enumeration of event types
@@ -23,73 +28,123 @@ enum EventType {
 };
 
 /**
- * A class holding information event information such as the time it occurs, the process it corresponds to, and the
- * type of the event.
+ * A class holding information event information such as the time it occurs, the type of the event, and what it
+ * happens to: the arriving process for arrivals, or the CPU core for departures and timeouts (a departure is always of
+ * the process on its core). Events are plain 16 byte values, so four fit in a cache line. The order events were
+ * scheduled in, which breaks ties between events at the same time, is kept by the event queue with their handles.
  */
 class Event {
 public:
 
-    Event(double time, Process* process, EventType type) {
+    Event() = default;
+
+    Event(SimTime time, EventType type, unsigned subject, EventHandle handle) {
         this->time = time;
-        this->process = process;
-        this->type = type;
+        this->handle = handle;
+        this->kind = (uint32_t) type << TYPE_SHIFT | subject;
     }
 
-    double getTime() { return this->time; }
-    Process* getProcess() { return this->process; }
-    EventType getType() { return this->type; }
+    SimTime getTime() const { return this->time; }
+    EventType getType() const { return (EventType) (this->kind >> TYPE_SHIFT); }
+    ProcessId getProcess() const { return this->kind & SUBJECT_MASK; }
+    unsigned getCore() const { return this->kind & SUBJECT_MASK; }
+    EventHandle getHandle() const { return this->handle; }
+
+    // The type is packed into the top two bits of the same word as the process or core
+    static const unsigned TYPE_SHIFT = 30;
+    static const uint32_t SUBJECT_MASK = (1u << TYPE_SHIFT) - 1;
+
+private:
+    SimTime time;
+    EventHandle handle;
+    uint32_t kind;
+
+};
+
+static_assert(sizeof(Event) == 16 && std::is_trivial<Event>::value && std::is_standard_layout<Event>::value,
+              "Events should be 16 byte plain values");
+
+/**
+ * Orders events based on their time (unless their times are equal, then event type is used as an arbitrary
+ * tie-breaker, followed by the order the events were scheduled in).
+ */
+class EventOrder {
+public:
+
+    /**
+     * Creates an EventOrder.
+     * @param sequences The sequence number of each handle's event, from the event queue's EventHandleTable.
+     */
+    explicit EventOrder(const vector<unsigned long>* sequences) : sequences(sequences) {}
 
     /**
-     * Function for comparing two events. Events are compared based on their time (unless their times are equal, then
-     * event type is used as an arbitrary tie-breaker).
-     * @param other The event to compare this event to.
-     * @return True if this event is less than other, otherwise false.
+     * Compares two events.
+     * @return True if a comes before b, otherwise false.
      */
-    bool operator<(const Event& other) const {
-        if (this->time != other.time)
-            return this->time < other.time;
+    bool operator()(const Event& a, const Event& b) const {
+        if (a.getTime() != b.getTime())
+            return a.getTime() < b.getTime();
+        else if (a.getType() != b.getType())
+            return a.getType() < b.getType();
         else
-            return this->type < other.type;
+            return (*sequences)[a.getHandle()] < (*sequences)[b.getHandle()];
     }
 
 private:
-    double time;
-    Process* process;
-    EventType type;
+    const vector<unsigned long>* sequences;
 
 };
 
 /**
- * A class to hold events in a queue-like structure ordered by the time they will occur.
+ * A class to hold events in a queue-like structure ordered by the time they will occur. Scheduling an event returns a
+ * handle that can be used to cancel the event later without searching the queue.
  */
 class EventQueue {
 
 public:
+    /**
+     * Creates an empty EventQueue.
+     * @param lazyCancellation If true, cancelled events are only marked as cancelled (tombstoned) and are skipped when
+     *        they reach the front of the queue, instead of being removed right away.
+     */
+    explicit EventQueue(bool lazyCancellation = false) : events(EventOrder(&handles.getSequences())) {
+        this->lazyCancellation = lazyCancellation;
+    }
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
     /**
      * Creates an Event and adds it to the EventQueue.
      * @param time The time the event occurs.
-     * @param p The process the event corresponds to.
      * @param type The type of the event.
+     * @param subject The process the event corresponds to (arrivals), or the CPU core it happens on (departures and
+     *        timeouts).
+     * @return A handle to the event, valid until the event is returned by getEvent() or cancelled.
      */
-    void scheduleEvent(double time, Process* p, EventType type) {
-        Event e (time, p, type);
-        events.insert(e);
+    EventHandle scheduleEvent(SimTime time, EventType type, unsigned subject = 0) {
+        EventHandle handle = handles.allocate();
+        Event e (time, type, subject, handle);
+        handles.location(handle) = events.insert(e).first;
+        return handle;
     }
 
     /**
-     * Unschedules (removes) a departure event (if it exists) from the EventQueue.
-     * @param id The departure's corresponding process' ID.
-     * @return True if the departure was successfully removed from the EventQueue, false if the departure wasn't present
-     * in the EventQueue to begin with.
+     * Cancels (removes) a scheduled event from the EventQueue.
+     * @param handle The handle returned when the event was scheduled.
+     * @return True if the event was cancelled, false if the handle doesn't refer to a pending event.
      */
-    bool unscheduleDeparture(int id) {
-        for (Event event : events) {
-            if (event.getType() == DEPARTURE && event.getProcess()->getId() == id) {
-                events.erase(event);
-                return true;
-            }
+    bool cancelEvent(EventHandle handle) {
+        if (!handles.isPending(handle))
+            return false;
+
+        if (lazyCancellation) {
+            handles.tombstone(handle);
+        } else {
+            events.erase(handles.location(handle));
+            handles.release(handle);
         }
-        return false;
+        return true;
     }
 
     /**
@@ -97,21 +152,67 @@ public:
      * @return The next event.
      */
     Event getEvent() {
+        purgeCancelled();
         Event event = *events.begin();
         events.erase(events.begin());
+        handles.release(event.getHandle());
         return event;
     }
 
+    /**
+     * Returns the time of the next event (the one with the soonest time) without removing it. Must not be called on an
+     * empty EventQueue.
+     * @return The time (in seconds) of the next event.
+     */
+    SimTime nextTime() {
+        purgeCancelled();
+        return events.begin()->getTime();
+    }
+
+    /**
+     * Returns the number of events in the EventQueue (not counting cancelled ones).
+     * @return The number of events scheduled.
+     */
+    size_t size() {
+        return handles.countPending();
+    }
+
     /**
      * Determines whether or not the EventQueue is empty.
      * @return True if the EventQueue is empty (has no events), false otherwise.
      */
     bool empty() {
+        purgeCancelled();
         return events.empty();
     }
 
+    /**
+     * Returns every pending event (not counting cancelled ones) in the order they will be handled.
+     * Scheduling them again in this order, into an empty event queue, gives an equivalent queue.
+     * @return The pending events, soonest first.
+     */
+    vector<Event> pendingEvents() {
+        vector<Event> pending;
+        for (const Event& e : events)
+            if (!handles.isTombstone(e.getHandle()))
+                pending.push_back(e);
+        return pending;
+    }
+
 private:
-    set<Event> events;
+    EventHandleTable<set<Event, EventOrder>::iterator> handles;
+    set<Event, EventOrder> events;
+    bool lazyCancellation;
+
+    /**
+     * Removes cancelled events from the front of the queue (only needed with lazy cancellation).
+     */
+    void purgeCancelled() {
+        while (!events.empty() && handles.isTombstone(events.begin()->getHandle())) {
+            handles.release(events.begin()->getHandle());
+            events.erase(events.begin());
+        }
+    }
 
 };
 
@@ -0,0 +1,311 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_HRRNREADYQUEUE_H
+#define CS4328_PROJECT1_HRRNREADYQUEUE_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "Process.h"
+
+using std::vector;
+using std::priority_queue;
+using std::greater;
+
+/**
+ * A ready queue specialized for the Highest Response Ratio Next (HRRN) priority scheme that never re-sorts its
+ * processes. A waiting process' response ratio at time t is 1 + (t - r) / s, where r is the time it started waiting
+ * and s its service time, so each ratio is a line in t. The processes are kept in a kinetic tournament tree: every
+ * internal node holds the winner (highest ratio) of its two children at the current time, along with a certificate
+ * stating when the loser's line will overtake the winner's. Advancing the time only revisits the nodes whose
+ * certificates have expired, instead of every waiting process.
+ *
+ * Every winner is decided by evaluating the response ratio exactly the way updateWaitTimes() and the
+ * HRRNPriorityComparator do, and certificates are scheduled slightly early to absorb rounding, so the scheduling
+ * decisions are identical to a ReadyQueue<HRRNPriorityComparator>.
+ * @tparam PriorityComparator Unused, the priority scheme is always HRRN (taken so the HRRNReadyQueue can stand in for a
+ * ReadyQueue in a SchedulingPolicy).
+ * @tparam Processes The table the processes are stored in (ProcessTable or ProcessPool).
+ */
+template <class PriorityComparator, class Processes>
+class HRRNReadyQueue {
+
+public:
+
+    /**
+     * Creates an empty HRRNReadyQueue.
+     * @param table The table the processes are stored in, which must outlive the HRRNReadyQueue.
+     */
+    explicit HRRNReadyQueue(Processes& table) {
+        this->table = &table;
+        this->now = 0;
+        this->count = 0;
+        resize(16);
+    }
+
+    /**
+     * Adds a process to the HRRNReadyQueue.
+     * @param p The process to add to the HRRNReadyQueue.
+     */
+    void add(ProcessId p) {
+        if (freeLeaves.empty())
+            resize(2 * capacity);
+
+        size_t leaf = freeLeaves.back();
+        freeLeaves.pop_back();
+
+        Entry& e = entries[leaf];
+        e.process = p;
+        e.serviceTime = table->getServiceTime(p);
+        e.arrivalTime = table->getArrivalTime(p);
+        e.id = table->getId(p);
+        // A process that has never been on the CPU has been waiting since it arrived
+        e.waitingSince = table->getLastTimeAssignedCpu(p) == -1 ? table->getArrivalTime(p)
+                                                                 : table->getLastTimeAssignedCpu(p);
+        count++;
+
+        setLeaf(leaf, (int) leaf);
+    }
+
+    /**
+     * Gets the process with the highest response ratio (as of the last call to updateWaitTimes()) and removes it from
+     * the HRRNReadyQueue.
+     * @return The process that was at the front of the HRRNReadyQueue.
+     */
+    ProcessId getFront() {
+        int leaf = winners[1];
+        ProcessId p = entries[leaf].process;
+        table->setWaitTime(p, now - entries[leaf].waitingSince);
+
+        entries[leaf].process = NO_PROCESS;
+        freeLeaves.push_back((size_t) leaf);
+        count--;
+
+        setLeaf((size_t) leaf, -1);
+        return p;
+    }
+
+    /**
+     * Returns the process with the highest response ratio (as of the last call to updateWaitTimes()) without removing
+     * it.
+     * @return The process at the front of the HRRNReadyQueue, which must not be empty.
+     */
+    ProcessId front() {
+        return entries[winners[1]].process;
+    }
+
+    /**
+     * Calls a function with every process in the HRRNReadyQueue, in an order that adding them back to an empty
+     * HRRNReadyQueue restores it.
+     * @param function The function, called as function(ProcessId).
+     */
+    template <class Function>
+    void forEachProcess(Function&& function) const {
+        for (const Entry& e : entries)
+            if (e.process != NO_PROCESS)
+                function(e.process);
+    }
+
+    /**
+     * Advances the HRRNReadyQueue to the current time, repairing the tree wherever a process' response ratio has
+     * overtaken another's since the last update.
+     * @param clock The current clock time (in seconds).
+     */
+    void updateWaitTimes(SimTime clock) {
+        now = clock;
+        while (!certificates.empty() && certificates.top().time <= now) {
+            Certificate c = certificates.top();
+            certificates.pop();
+            if (c.version != versions[c.node]) continue;
+
+            // Re-decide the expired node and every node above it
+            for (size_t node = c.node; node >= 1; node /= 2)
+                decide(node);
+        }
+
+        // Drop stale certificates once they outnumber the live ones
+        if (certificates.size() > 4 * capacity)
+            rebuild();
+    }
+
+    /**
+     * Does nothing, since the HRRNReadyQueue is kept in order as time advances.
+     */
+    void sort() {}
+
+    /**
+     * Determines whether the HRRNReadyQueue is empty (has no processes in it).
+     * @return True if the HRRNReadyQueue is empty, false otherwise.
+     */
+    bool empty() {
+        return count == 0;
+    }
+
+    /**
+     * Returns the size of the HRRNReadyQueue.
+     * @return The number of processes in the HRRNReadyQueue.
+     */
+    unsigned long size() {
+        return count;
+    }
+
+private:
+    /**
+     * A waiting process and the values its response ratio line is made of.
+     */
+    struct Entry {
+        ProcessId process;
+        SimTime waitingSince;
+        SimTime serviceTime;
+        SimTime arrivalTime;
+        int id;
+    };
+
+    /**
+     * A statement that a node's winner stays the winner until the given time.
+     */
+    struct Certificate {
+        double time;
+        size_t node;
+        unsigned long version;
+
+        bool operator>(const Certificate& other) const { return this->time > other.time; }
+    };
+
+    Processes* table;
+    SimTime now;
+    size_t count;
+    size_t capacity;
+
+    // Leaves of the tree (one per process slot), plus the winning leaf of every node (-1 if the subtree is empty).
+    // Node 1 is the root, node i has children 2i and 2i+1, and leaf j is node capacity + j.
+    vector<Entry> entries;
+    vector<int> winners;
+    vector<size_t> freeLeaves;
+
+    // Pending certificates, and a version per node so certificates replaced by a later decision can be skipped
+    priority_queue<Certificate, vector<Certificate>, greater<Certificate>> certificates;
+    vector<unsigned long> versions;
+
+    /**
+     * Computes a response ratio exactly as updateWaitTimes() and calcResponseRatio() in the general ReadyQueue do.
+     * @param e The waiting process.
+     * @param t The time (in seconds).
+     * @return The response ratio of the process at time t.
+     */
+    static double ratio(const Entry& e, SimTime t) {
+        SimTime waitTime = t - e.waitingSince;
+        return (double) (waitTime + e.serviceTime) / e.serviceTime;
+    }
+
+    /**
+     * Compares two waiting processes at a time, exactly as the HRRNPriorityComparator does.
+     * @return True if a has a higher priority than b at time t.
+     */
+    static bool beats(const Entry& a, const Entry& b, SimTime t) {
+        double ra = ratio(a, t), rb = ratio(b, t);
+        if (ra != rb)
+            return ra > rb;
+        else if (a.arrivalTime != b.arrivalTime)
+            return a.arrivalTime < b.arrivalTime;
+        else
+            return a.id < b.id;
+    }
+
+    /**
+     * Computes the earliest time the loser's ratio might overtake the winner's.
+     * @return The time (in the clock's representation) to check the two again, or infinity if the loser can never
+     *         overtake.
+     */
+    double overtakeTime(const Entry& winner, const Entry& loser) {
+        // The loser only catches up if its ratio grows faster, i.e. its service time is shorter
+        if (loser.serviceTime >= winner.serviceTime)
+            return INFINITY;
+
+        // The lines are worked out in floating point whatever the clock
+        double winnerSince = (double) winner.waitingSince, winnerService = (double) winner.serviceTime;
+        double loserSince = (double) loser.waitingSince, loserService = (double) loser.serviceTime;
+        double slopeDifference = 1 / loserService - 1 / winnerService;
+        double crossing = (loserSince * winnerService - winnerSince * loserService) / (winnerService - loserService);
+
+        // Check a little early, by more than rounding in the ratios (or in the crossing itself) could account for
+        double ratioMagnitude = (std::fabs(crossing) + std::fabs(winnerSince)) / winnerService
+                                + (std::fabs(crossing) + std::fabs(loserSince)) / loserService + 2;
+        double margin = 1e-9 * (std::fabs(crossing) + 1) + 16 * DBL_EPSILON * ratioMagnitude / slopeDifference;
+        return crossing - margin;
+    }
+
+    /**
+     * Decides the winner of a node from its children's winners at the current time, and certifies the decision.
+     * @param node The node to decide.
+     */
+    void decide(size_t node) {
+        int a = winners[2 * node], b = winners[2 * node + 1];
+        versions[node]++;
+
+        if (a == -1 || b == -1) {
+            winners[node] = a == -1 ? b : a;
+            return;
+        }
+
+        int winner = beats(entries[a], entries[b], now) ? a : b;
+        int loser = winner == a ? b : a;
+        winners[node] = winner;
+
+        double time = overtakeTime(entries[winner], entries[loser]);
+        if (time == INFINITY) return;
+        // Already checked at the current time, so the next check must be strictly later
+        if (time <= now) time = std::nextafter((double) now, INFINITY);
+        certificates.push({time, node, versions[node]});
+    }
+
+    /**
+     * Changes the contents of a leaf and re-decides the nodes above it.
+     * @param leaf The leaf to change.
+     * @param value The leaf's index if it now holds a process, -1 if it is now empty.
+     */
+    void setLeaf(size_t leaf, int value) {
+        size_t node = capacity + leaf;
+        winners[node] = value;
+        for (node /= 2; node >= 1; node /= 2)
+            decide(node);
+    }
+
+    /**
+     * Re-decides every node from the bottom up, discarding all certificates.
+     */
+    void rebuild() {
+        certificates = priority_queue<Certificate, vector<Certificate>, greater<Certificate>>();
+        for (size_t node = capacity - 1; node >= 1; node--)
+            decide(node);
+    }
+
+    /**
+     * Grows the tree to hold a new number of processes.
+     * @param newCapacity The new number of leaves (a power of two).
+     */
+    void resize(size_t newCapacity) {
+        // Only called once every leaf is taken, so the new leaves are the free ones
+        size_t oldCapacity = entries.size();
+        entries.resize(newCapacity, Entry {NO_PROCESS, 0, 0, 0, 0});
+        for (size_t leaf = newCapacity; leaf-- > oldCapacity;)
+            freeLeaves.push_back(leaf);
+
+        capacity = newCapacity;
+        winners.assign(2 * capacity, -1);
+        versions.assign(2 * capacity, 0);
+        for (size_t leaf = 0; leaf < capacity; leaf++)
+            winners[capacity + leaf] = entries[leaf].process == NO_PROCESS ? -1 : (int) leaf;
+        rebuild();
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_HRRNREADYQUEUE_H
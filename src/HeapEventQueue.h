@@ -0,0 +1,209 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_HEAPEVENTQUEUE_H
+#define CS4328_PROJECT1_HEAPEVENTQUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "EventQueue.h"
+
+using std::vector;
+
+/**
+ * An event queue backed by a 4-ary min-heap stored in a contiguous array. Compared to the node based EventQueue there
+ * is no allocation per event, and the shallower, wider heap keeps more of each sift inside a single cache line. Each
+ * event's position in the heap is tracked through its handle, so cancelling an event is an O(log n) removal.
+ */
+class HeapEventQueue {
+
+public:
+    /**
+     * Creates an empty HeapEventQueue.
+     * @param lazyCancellation If true, cancelled events are only marked as cancelled (tombstoned) and are skipped when
+     *        they reach the top of the heap, instead of being removed right away.
+     */
+    explicit HeapEventQueue(bool lazyCancellation = false) : before(&handles.getSequences()) {
+        this->lazyCancellation = lazyCancellation;
+    }
+
+    HeapEventQueue(const HeapEventQueue&) = delete;
+    HeapEventQueue& operator=(const HeapEventQueue&) = delete;
+
+    /**
+     * Creates an Event and adds it to the HeapEventQueue.
+     * @param time The time the event occurs.
+     * @param type The type of the event.
+     * @param subject The process the event corresponds to (arrivals), or the CPU core it happens on (departures and
+     *        timeouts).
+     * @return A handle to the event, valid until the event is returned by getEvent() or cancelled.
+     */
+    EventHandle scheduleEvent(SimTime time, EventType type, unsigned subject = 0) {
+        EventHandle handle = handles.allocate();
+        heap.emplace_back(time, type, subject, handle);
+        siftUp(heap.size() - 1);
+        return handle;
+    }
+
+    /**
+     * Cancels (removes) a scheduled event from the HeapEventQueue.
+     * @param handle The handle returned when the event was scheduled.
+     * @return True if the event was cancelled, false if the handle doesn't refer to a pending event.
+     */
+    bool cancelEvent(EventHandle handle) {
+        if (!handles.isPending(handle))
+            return false;
+
+        if (lazyCancellation) {
+            handles.tombstone(handle);
+        } else {
+            removeAt(handles.location(handle));
+            handles.release(handle);
+        }
+        return true;
+    }
+
+    /**
+     * Gets the next event (the one with the soonest time) and removes it from the HeapEventQueue.
+     * @return The next event.
+     */
+    Event getEvent() {
+        purgeCancelled();
+        Event event = heap[0];
+        removeAt(0);
+        handles.release(event.getHandle());
+        return event;
+    }
+
+    /**
+     * Returns the time of the next event (the one with the soonest time) without removing it. Must not be called on an
+     * empty HeapEventQueue.
+     * @return The time (in seconds) of the next event.
+     */
+    SimTime nextTime() {
+        purgeCancelled();
+        return heap[0].getTime();
+    }
+
+    /**
+     * Returns the number of events in the HeapEventQueue (not counting cancelled ones).
+     * @return The number of events scheduled.
+     */
+    size_t size() {
+        return handles.countPending();
+    }
+
+    /**
+     * Determines whether or not the HeapEventQueue is empty.
+     * @return True if the HeapEventQueue is empty (has no events), false otherwise.
+     */
+    bool empty() {
+        purgeCancelled();
+        return heap.empty();
+    }
+
+    /**
+     * Returns every pending event (not counting cancelled ones) in the order they will be handled.
+     * Scheduling them again in this order, into an empty event queue, gives an equivalent queue.
+     * @return The pending events, soonest first.
+     */
+    vector<Event> pendingEvents() {
+        vector<Event> pending;
+        for (const Event& e : heap)
+            if (!handles.isTombstone(e.getHandle()))
+                pending.push_back(e);
+        std::sort(pending.begin(), pending.end(), before);
+        return pending;
+    }
+
+private:
+    vector<Event> heap;
+    EventHandleTable<size_t> handles;
+    EventOrder before;
+    bool lazyCancellation;
+
+    /**
+     * Moves an event to a position in the heap and records its new position.
+     * @param i The position to move the event to.
+     * @param e The event.
+     */
+    void place(size_t i, const Event& e) {
+        heap[i] = e;
+        handles.location(e.getHandle()) = i;
+    }
+
+    /**
+     * Moves the event at a position up the heap until its parent is sooner.
+     * @param i The position of the event.
+     */
+    void siftUp(size_t i) {
+        Event e = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 4;
+            if (!before(e, heap[parent])) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, e);
+    }
+
+    /**
+     * Moves the event at a position down the heap until all its children are later.
+     * @param i The position of the event.
+     */
+    void siftDown(size_t i) {
+        Event e = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t first = 4 * i + 1;
+            if (first >= n) break;
+
+            // Find the soonest of the (up to) four children
+            size_t last = first + 4 < n ? first + 4 : n;
+            size_t best = first;
+            for (size_t child = first + 1; child < last; child++)
+                if (before(heap[child], heap[best])) best = child;
+
+            if (!before(heap[best], e)) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, e);
+    }
+
+    /**
+     * Removes the event at a position from the heap, filling the gap with the last event.
+     * @param i The position of the event to remove.
+     */
+    void removeAt(size_t i) {
+        size_t lastIndex = heap.size() - 1;
+        if (i != lastIndex) {
+            place(i, heap[lastIndex]);
+            heap.pop_back();
+            // The moved event may belong above or below its new position
+            if (i > 0 && before(heap[i], heap[(i - 1) / 4]))
+                siftUp(i);
+            else
+                siftDown(i);
+        } else {
+            heap.pop_back();
+        }
+    }
+
+    /**
+     * Removes cancelled events from the top of the heap (only needed with lazy cancellation).
+     */
+    void purgeCancelled() {
+        while (!heap.empty() && handles.isTombstone(heap[0].getHandle())) {
+            handles.release(heap[0].getHandle());
+            removeAt(0);
+        }
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_HEAPEVENTQUEUE_H
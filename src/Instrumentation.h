@@ -0,0 +1,288 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_INSTRUMENTATION_H
+#define CS4328_PROJECT1_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Opt-in profiling of the simulation's hot path. Building with SCHEDSIM_INSTRUMENT defined makes every simulation
+ * count its events by type, track the depth of its event and ready queues, time its event handlers (and the event
+ * cancellations and priority updates within them) and read the CPU's hardware counters where Linux allows it. The
+ * profile is printed after the statistics. Without SCHEDSIM_INSTRUMENT, every use is behind `if constexpr
+ * (INSTRUMENTED)` and compiles to nothing.
+ */
+#ifdef SCHEDSIM_INSTRUMENT
+constexpr bool INSTRUMENTED = true;
+#else
+constexpr bool INSTRUMENTED = false;
+#endif
+
+/**
+ * The parts of the simulation that are timed. The handlers come first, in the same order as EventType.
+ * Event cancellation: unscheduling a departure or timeout (part of the handler that does it).
+ * Priority update: updating wait times and re-sorting a ready queue with dynamic priorities (part of the handler).
+ */
+enum ProfiledSection {
+    ARRIVAL_HANDLER, DEPARTURE_HANDLER, TIMEOUT_HANDLER, QUERY_HANDLER, EVENT_CANCELLATION, PRIORITY_UPDATE,
+    NUM_PROFILED_SECTIONS
+};
+
+/**
+ * Reads a cheap, monotonic tick counter for timing short sections: the time stamp counter on x86, nanoseconds of the
+ * steady clock elsewhere.
+ * @return The current tick count.
+ */
+inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Reads the steady clock.
+ * @return The steady clock's time (in nanoseconds).
+ */
+inline uint64_t readNanoseconds() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Hardware event counts over a run, as read from the CPU's performance counters.
+ */
+struct HardwareCounts {
+    bool available = false;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cacheMisses = 0;
+    uint64_t branchMisses = 0;
+};
+
+/**
+ * A group of Linux hardware performance counters (cycles, instructions, cache misses and branch misses) counting the
+ * calling thread in user space. If perf_event_open isn't available or permitted (as in many containers), the counters
+ * simply report themselves unavailable.
+ */
+class HardwareCounters {
+
+public:
+
+    /**
+     * Opens the counters, stopped.
+     */
+    HardwareCounters() {
+        this->count = 0;
+#if defined(__linux__)
+        const uint64_t events[] {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+                                 PERF_COUNT_HW_BRANCH_MISSES};
+        for (uint64_t event : events) {
+            struct perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = event;
+            attr.disabled = count == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, count == 0 ? -1 : fds[0], 0);
+            if (fd == -1) break;
+            fds[count++] = fd;
+        }
+        // Only report counts if every counter could be opened
+        if (count < NUM_COUNTERS) close();
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    ~HardwareCounters() { close(); }
+
+    /**
+     * Resets and starts the counters.
+     */
+    void start() {
+#if defined(__linux__)
+        if (count == 0) return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    /**
+     * Stops the counters and reads them.
+     * @return The counts since start(), or unavailable counts.
+     */
+    HardwareCounts stop() {
+        HardwareCounts counts;
+#if defined(__linux__)
+        if (count == 0) return counts;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[1 + NUM_COUNTERS];
+        if (read(fds[0], values, sizeof(values)) != (ssize_t) sizeof(values) || values[0] != NUM_COUNTERS)
+            return counts;
+        counts.available = true;
+        counts.cycles = values[1];
+        counts.instructions = values[2];
+        counts.cacheMisses = values[3];
+        counts.branchMisses = values[4];
+#endif
+        return counts;
+    }
+
+private:
+    static const int NUM_COUNTERS = 4;
+    int fds[NUM_COUNTERS];
+    int count;
+
+    /**
+     * Closes every counter opened.
+     */
+    void close() {
+#if defined(__linux__)
+        while (count > 0)
+            ::close(fds[--count]);
+#endif
+    }
+
+};
+
+/**
+ * The profile of one or more simulations: events handled by type, event and ready queue depths seen by each event, time
+ * spent in each ProfiledSection, and hardware counts. Times are kept in ticks (see readTicks()) and converted to
+ * nanoseconds using the ticks and nanoseconds that passed over the whole run.
+ */
+struct EventProfile {
+    unsigned long sectionCalls[NUM_PROFILED_SECTIONS] {};
+    uint64_t sectionTicks[NUM_PROFILED_SECTIONS] {};
+
+    // Depths (including the event being handled) summed over every event, and the deepest seen
+    unsigned long eventQueueDepthTotal = 0, readyQueueDepthTotal = 0;
+    unsigned long maxEventQueueDepth = 0, maxReadyQueueDepth = 0;
+
+    // When the run started, and (once stopped) how long it took, for converting ticks to nanoseconds
+    uint64_t startTicks = 0, startNanoseconds = 0;
+    uint64_t elapsedTicks = 0, elapsedNanoseconds = 0;
+
+    HardwareCounts hardware;
+
+    /**
+     * Starts the run's clock.
+     */
+    void start() {
+        startTicks = readTicks();
+        startNanoseconds = readNanoseconds();
+    }
+
+    /**
+     * Stops the run's clock.
+     */
+    void stop() {
+        elapsedTicks = readTicks() - startTicks;
+        elapsedNanoseconds = readNanoseconds() - startNanoseconds;
+    }
+
+    /**
+     * Records one event.
+     * @param handler The handler of the event's type.
+     * @param ticks The ticks spent handling it.
+     * @param eventQueueDepth The number of events pending when it was handled (including itself).
+     * @param readyQueueDepth The number of processes waiting when it was handled.
+     */
+    void recordEvent(ProfiledSection handler, uint64_t ticks, unsigned long eventQueueDepth,
+                     unsigned long readyQueueDepth) {
+        addSection(handler, ticks);
+        eventQueueDepthTotal += eventQueueDepth;
+        readyQueueDepthTotal += readyQueueDepth;
+        if (eventQueueDepth > maxEventQueueDepth) maxEventQueueDepth = eventQueueDepth;
+        if (readyQueueDepth > maxReadyQueueDepth) maxReadyQueueDepth = readyQueueDepth;
+    }
+
+    /**
+     * Records one pass through a section.
+     * @param section The section.
+     * @param ticks The ticks spent in it.
+     */
+    void addSection(ProfiledSection section, uint64_t ticks) {
+        sectionCalls[section]++;
+        sectionTicks[section] += ticks;
+    }
+
+    /**
+     * Adds another profile to this one.
+     * @param other The profile to add.
+     */
+    void merge(const EventProfile& other) {
+        for (int i = 0; i < NUM_PROFILED_SECTIONS; i++) {
+            sectionCalls[i] += other.sectionCalls[i];
+            sectionTicks[i] += other.sectionTicks[i];
+        }
+        eventQueueDepthTotal += other.eventQueueDepthTotal;
+        readyQueueDepthTotal += other.readyQueueDepthTotal;
+        if (other.maxEventQueueDepth > maxEventQueueDepth) maxEventQueueDepth = other.maxEventQueueDepth;
+        if (other.maxReadyQueueDepth > maxReadyQueueDepth) maxReadyQueueDepth = other.maxReadyQueueDepth;
+        elapsedTicks += other.elapsedTicks;
+        elapsedNanoseconds += other.elapsedNanoseconds;
+        hardware.available = hardware.available && other.hardware.available;
+        hardware.cycles += other.hardware.cycles;
+        hardware.instructions += other.hardware.instructions;
+        hardware.cacheMisses += other.hardware.cacheMisses;
+        hardware.branchMisses += other.hardware.branchMisses;
+    }
+
+    /**
+     * Prints the profile.
+     */
+    void display() const {
+        const char* names[] {"Arrival", "Departure", "Timeout", "Query", "  Cancellation", "  Priority Update"};
+        double nsPerTick = elapsedTicks > 0 ? (double) elapsedNanoseconds / elapsedTicks : 0;
+
+        unsigned long events = 0;
+        for (int i = 0; i <= QUERY_HANDLER; i++)
+            events += sectionCalls[i];
+
+        printf("              Events : %6lu  in %.3f s\n", events, elapsedNanoseconds / 1e9);
+        for (int i = 0; i < NUM_PROFILED_SECTIONS; i++) {
+            if (sectionCalls[i] == 0) continue;
+            printf("%20s : %10lu  %8.1f ns avg  %8.3f s total\n", names[i], sectionCalls[i],
+                   sectionTicks[i] * nsPerTick / sectionCalls[i], sectionTicks[i] * nsPerTick / 1e9);
+        }
+        if (events > 0)
+            printf("   Event Queue Depth : %8.1f avg  %lu max\n"
+                   "   Ready Queue Depth : %8.1f avg  %lu max\n",
+                   (double) eventQueueDepthTotal / events, maxEventQueueDepth,
+                   (double) readyQueueDepthTotal / events, maxReadyQueueDepth);
+        if (hardware.available && events > 0)
+            printf("  Cycles/Instr/Event : %.0f / %.0f  (IPC %.2f)\n"
+                   " Cache/Branch Misses : %.2f / %.2f per event\n",
+                   (double) hardware.cycles / events, (double) hardware.instructions / events,
+                   (double) hardware.instructions / hardware.cycles, (double) hardware.cacheMisses / events,
+                   (double) hardware.branchMisses / events);
+        else
+            printf("   Hardware Counters : unavailable\n");
+    }
+};
+
+
+#endif //CS4328_PROJECT1_INSTRUMENTATION_H
@@ -0,0 +1,656 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_JOBJSON_H
+#define CS4328_PROJECT1_JOBJSON_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SchedulerSimulator.h"
+
+using std::pair;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+/*
+ * Jobs as JSON, for the server mode and the C interface. A job is one JSON object, such as
+ *   {"id": 7, "scheduler": "srtf", "arrival_rate": 12, "service_time": 0.06, "seed": 3}
+ * whose keys are the command line options in snake case (see parseJobSpec()), and its result is one JSON object on one
+ * line, such as
+ *   {"id": 7, "seed": 3, "replications": 1, "statistics": {"avg_turnaround_time": 0.18, ...}, "wall_time": 0.004}
+ * or {"id": 7, "error": "..."} if the job is invalid or fails. The id is any JSON value, echoed back as it was given so
+ * results can be matched to their jobs however they are ordered.
+ */
+
+/**
+ * A parsed JSON value. Numbers keep their text, so integers too big for a double (such as seeds) are read exactly.
+ */
+struct JsonValue {
+    enum Type {
+        NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+    };
+
+    Type type = NULL_VALUE;
+    bool boolean = false;
+    // The text of a number, or the (unescaped) contents of a string
+    string text;
+    vector<JsonValue> items;
+    vector<pair<string, JsonValue>> members;
+    // Where the value is in the text it was parsed from
+    size_t begin = 0, end = 0;
+
+    /**
+     * Looks up a member of an object.
+     * @param key The member's key.
+     * @return The member's value, or nullptr if this isn't an object or has no such member.
+     */
+    const JsonValue* find(const string& key) const {
+        for (const auto& member : members)
+            if (member.first == key) return &member.second;
+        return nullptr;
+    }
+};
+
+/**
+ * A recursive descent parser for a single JSON value (RFC 8259), with nesting limited so malicious input can't
+ * overflow the stack.
+ */
+class JsonParser {
+
+public:
+
+    /**
+     * Parses a JSON value, which must be all of the text (apart from whitespace).
+     * @param text The text.
+     * @return The value.
+     * @throws runtime_error If the text isn't valid JSON.
+     */
+    static JsonValue parse(const string& text) {
+        JsonParser parser(text);
+        JsonValue value = parser.parseValue(0);
+        parser.skipWhitespace();
+        if (parser.position != text.size())
+            parser.fail("unexpected text after the value");
+        return value;
+    }
+
+private:
+    static const int MAX_DEPTH = 64;
+
+    const string& text;
+    size_t position;
+
+    explicit JsonParser(const string& text) : text(text) {
+        this->position = 0;
+    }
+
+    [[noreturn]] void fail(const string& message) {
+        throw runtime_error("Invalid JSON at offset " + std::to_string(position) + ": " + message);
+    }
+
+    void skipWhitespace() {
+        while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n'
+                                          || text[position] == '\r'))
+            position++;
+    }
+
+    void expect(const char* literal) {
+        for (const char* c = literal; *c != '\0'; c++, position++)
+            if (position >= text.size() || text[position] != *c)
+                fail(string("expected \"") + literal + "\"");
+    }
+
+    JsonValue parseValue(int depth) {
+        if (depth > MAX_DEPTH)
+            fail("nested too deeply");
+        skipWhitespace();
+        if (position >= text.size())
+            fail("expected a value");
+
+        JsonValue value;
+        value.begin = position;
+        char c = text[position];
+        if (c == '{') {
+            value.type = JsonValue::OBJECT;
+            position++;
+            skipWhitespace();
+            if (position < text.size() && text[position] == '}') {
+                position++;
+            } else {
+                while (true) {
+                    skipWhitespace();
+                    if (position >= text.size() || text[position] != '"')
+                        fail("expected a key");
+                    string key = parseString();
+                    skipWhitespace();
+                    expect(":");
+                    value.members.emplace_back(std::move(key), parseValue(depth + 1));
+                    skipWhitespace();
+                    if (position < text.size() && text[position] == ',') {
+                        position++;
+                        continue;
+                    }
+                    expect("}");
+                    break;
+                }
+            }
+        } else if (c == '[') {
+            value.type = JsonValue::ARRAY;
+            position++;
+            skipWhitespace();
+            if (position < text.size() && text[position] == ']') {
+                position++;
+            } else {
+                while (true) {
+                    value.items.push_back(parseValue(depth + 1));
+                    skipWhitespace();
+                    if (position < text.size() && text[position] == ',') {
+                        position++;
+                        continue;
+                    }
+                    expect("]");
+                    break;
+                }
+            }
+        } else if (c == '"') {
+            value.type = JsonValue::STRING;
+            value.text = parseString();
+        } else if (c == 't') {
+            expect("true");
+            value.type = JsonValue::BOOLEAN;
+            value.boolean = true;
+        } else if (c == 'f') {
+            expect("false");
+            value.type = JsonValue::BOOLEAN;
+        } else if (c == 'n') {
+            expect("null");
+        } else {
+            value.type = JsonValue::NUMBER;
+            value.text = parseNumber();
+        }
+        value.end = position;
+        return value;
+    }
+
+    string parseNumber() {
+        size_t start = position;
+        auto digits = [&]() {
+            size_t first = position;
+            while (position < text.size() && text[position] >= '0' && text[position] <= '9')
+                position++;
+            if (position == first)
+                fail("expected a digit");
+        };
+        if (text[position] == '-')
+            position++;
+        if (position < text.size() && text[position] == '0')
+            position++;
+        else
+            digits();
+        if (position < text.size() && text[position] == '.') {
+            position++;
+            digits();
+        }
+        if (position < text.size() && (text[position] == 'e' || text[position] == 'E')) {
+            position++;
+            if (position < text.size() && (text[position] == '+' || text[position] == '-'))
+                position++;
+            digits();
+        }
+        return text.substr(start, position - start);
+    }
+
+    unsigned parseHex4() {
+        unsigned code = 0;
+        for (int i = 0; i < 4; i++, position++) {
+            if (position >= text.size())
+                fail("unterminated escape");
+            char h = text[position];
+            code <<= 4u;
+            if (h >= '0' && h <= '9') code |= (unsigned) (h - '0');
+            else if (h >= 'a' && h <= 'f') code |= (unsigned) (h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') code |= (unsigned) (h - 'A' + 10);
+            else fail("invalid escape");
+        }
+        return code;
+    }
+
+    string parseString() {
+        string s;
+        position++;
+        while (true) {
+            if (position >= text.size())
+                fail("unterminated string");
+            char c = text[position++];
+            if (c == '"')
+                return s;
+            if ((unsigned char) c < 0x20)
+                fail("control character in string");
+            if (c != '\\') {
+                s += c;
+                continue;
+            }
+            if (position >= text.size())
+                fail("unterminated escape");
+            char e = text[position++];
+            switch (e) {
+                case '"': s += '"'; break;
+                case '\\': s += '\\'; break;
+                case '/': s += '/'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u': {
+                    unsigned code = parseHex4();
+                    // Join a surrogate pair into one code point
+                    if (code >= 0xd800 && code < 0xdc00 && position + 1 < text.size() && text[position] == '\\'
+                        && text[position + 1] == 'u') {
+                        position += 2;
+                        unsigned low = parseHex4();
+                        if (low < 0xdc00 || low >= 0xe000)
+                            fail("invalid surrogate pair");
+                        code = 0x10000 + ((code - 0xd800) << 10u) + (low - 0xdc00);
+                    }
+                    appendUtf8(s, code);
+                    break;
+                }
+                default:
+                    fail("invalid escape");
+            }
+        }
+    }
+
+    static void appendUtf8(string& s, unsigned code) {
+        if (code < 0x80) {
+            s += (char) code;
+        } else if (code < 0x800) {
+            s += (char) (0xc0 | (code >> 6u));
+            s += (char) (0x80 | (code & 0x3fu));
+        } else if (code < 0x10000) {
+            s += (char) (0xe0 | (code >> 12u));
+            s += (char) (0x80 | ((code >> 6u) & 0x3fu));
+            s += (char) (0x80 | (code & 0x3fu));
+        } else {
+            s += (char) (0xf0 | (code >> 18u));
+            s += (char) (0x80 | ((code >> 12u) & 0x3fu));
+            s += (char) (0x80 | ((code >> 6u) & 0x3fu));
+            s += (char) (0x80 | (code & 0x3fu));
+        }
+    }
+
+};
+
+/**
+ * Reads a JSON number as a real number.
+ * @param value The value.
+ * @param key The key of the value, for the error message.
+ * @return The number.
+ * @throws runtime_error If the value isn't a number.
+ */
+inline double jsonDouble(const JsonValue& value, const string& key) {
+    if (value.type != JsonValue::NUMBER)
+        throw runtime_error("\"" + key + "\" must be a number");
+    return strtod(value.text.c_str(), nullptr);
+}
+
+/**
+ * Reads a JSON number as a non-negative integer.
+ * @param value The value.
+ * @param key The key of the value, for the error message.
+ * @param max The largest value allowed.
+ * @return The number.
+ * @throws runtime_error If the value isn't an integer between 0 and max.
+ */
+inline unsigned long long jsonUnsigned(const JsonValue& value, const string& key, unsigned long long max) {
+    if (value.type != JsonValue::NUMBER || value.text.find_first_not_of("0123456789") != string::npos)
+        throw runtime_error("\"" + key + "\" must be a non-negative integer");
+    errno = 0;
+    unsigned long long n = strtoull(value.text.c_str(), nullptr, 10);
+    if (errno == ERANGE || n > max)
+        throw runtime_error("\"" + key + "\" must be at most " + std::to_string(max));
+    return n;
+}
+
+/**
+ * Reads a JSON string.
+ * @param value The value.
+ * @param key The key of the value, for the error message.
+ * @return The string.
+ * @throws runtime_error If the value isn't a string.
+ */
+inline const string& jsonString(const JsonValue& value, const string& key) {
+    if (value.type != JsonValue::STRING)
+        throw runtime_error("\"" + key + "\" must be a string");
+    return value.text;
+}
+
+/**
+ * Reads a JSON boolean.
+ * @param value The value.
+ * @param key The key of the value, for the error message.
+ * @return The boolean.
+ * @throws runtime_error If the value isn't a boolean.
+ */
+inline bool jsonBool(const JsonValue& value, const string& key) {
+    if (value.type != JsonValue::BOOLEAN)
+        throw runtime_error("\"" + key + "\" must be true or false");
+    return value.boolean;
+}
+
+/**
+ * Which files jobs may read and write (traces and checkpoints). Jobs run in-process may name any path, but jobs served
+ * to other processes may only name plain file names, which are looked up in one directory.
+ */
+struct JobFileAccess {
+    // Whether jobs may name any path
+    bool anyPath = true;
+    // Otherwise, the directory the files jobs name are in (empty if jobs may name no files)
+    string directory;
+};
+
+/**
+ * Finds the file a job names.
+ * @param name The name the job gives.
+ * @param access Which files the job may name.
+ * @param key The key of the name, for the error message.
+ * @return The path of the file.
+ * @throws runtime_error If the job may not name the file.
+ */
+inline string jobFilePath(const string& name, const JobFileAccess& access, const string& key) {
+    if (access.anyPath)
+        return name;
+    if (access.directory.empty())
+        throw runtime_error("\"" + key + "\" can only be given to a server started with --job-dir");
+    if (name.empty() || name == "." || name == ".." || name.find_first_of(string("/\0", 2)) != string::npos)
+        throw runtime_error("\"" + key + "\" must be the name of a file in the job directory");
+    return access.directory + "/" + name;
+}
+
+/**
+ * Makes a job out of a JSON object. Its keys are the command line options in snake case, all optional:
+ *   scheduler (1-6 or fcfs, srtf, hrrn, rr, mlfq, cfs; fcfs by default), arrival_rate, service_time, quantum,
+ *   processes, seed (a random seed by default), stream, queue (set, heap, calendar), query_interval, lazy_cancel,
+ *   cores, per_core_queues, trace, levels, level_quanta (an array), boost_interval, target_latency, warmup, checkpoint,
+ *   checkpoint_at, resume, reset_statistics, clusters, dispatch_delay, routing (round-robin, least-loaded),
+ *   replications, max_replications, precision, confidence
+ * and id, which is ignored. Any other key is an error, so a misspelt option is never silently left at its default. As
+ * on the command line, giving a cluster option simulates the cluster model, and a trace is replayed whole unless the
+ * number of processes is given. Clusters run one after another, since jobs already run in parallel.
+ * @param request The JSON object.
+ * @param access Which files the job may name (any by default).
+ * @return The job, which hasn't been validated (see validateJob()).
+ * @throws runtime_error If the object has an unknown key, a value of the wrong type, or a file it may not name.
+ */
+inline JobSpec parseJobSpec(const JsonValue& request, const JobFileAccess& access = JobFileAccess()) {
+    if (request.type != JsonValue::OBJECT)
+        throw runtime_error("A job must be a JSON object");
+
+    JobSpec job;
+    job.seed = RandomStream::randomSeed();
+    job.cluster.numThreads = 1;
+    bool numProcessesGiven = false;
+    SimulationConfig& config = job.config;
+
+    for (const auto& member : request.members) {
+        const string& key = member.first;
+        const JsonValue& value = member.second;
+        if (key == "id")
+            continue;
+        else if (key == "scheduler") {
+            if (value.type == JsonValue::STRING) {
+                const char* names[] {"fcfs", "srtf", "hrrn", "rr", "mlfq", "cfs"};
+                job.scheduler = 0;
+                for (int i = 0; i < 6; i++)
+                    if (value.text == names[i]) job.scheduler = i + 1;
+                if (job.scheduler == 0)
+                    throw runtime_error("Invalid scheduler \"" + value.text + "\". Available choices: fcfs, srtf, "
+                                        "hrrn, rr, mlfq, cfs");
+            } else {
+                job.scheduler = (int) jsonUnsigned(value, key, INT_MAX);
+            }
+        }
+        else if (key == "arrival_rate")
+            config.arrivalRate = jsonDouble(value, key);
+        else if (key == "service_time")
+            config.serviceTime = jsonDouble(value, key);
+        else if (key == "quantum")
+            config.quantumLength = jsonDouble(value, key);
+        else if (key == "processes") {
+            config.numProcesses = (int) jsonUnsigned(value, key, INT_MAX);
+            numProcessesGiven = true;
+        }
+        else if (key == "seed")
+            job.seed = (unsigned long) jsonUnsigned(value, key, ULONG_MAX);
+        else if (key == "stream")
+            job.stream = (unsigned long) jsonUnsigned(value, key, ULONG_MAX);
+        else if (key == "queue") {
+            const string& name = jsonString(value, key);
+            if (name == "set")
+                job.backend = SET_QUEUE;
+            else if (name == "heap")
+                job.backend = HEAP_QUEUE;
+            else if (name == "calendar")
+                job.backend = CALENDAR_QUEUE;
+            else
+                throw runtime_error("Invalid event queue \"" + name + "\". Available choices: set, heap, calendar");
+        }
+        else if (key == "query_interval")
+            config.queryInterval = jsonDouble(value, key);
+        else if (key == "lazy_cancel")
+            config.lazyCancellation = jsonBool(value, key);
+        else if (key == "cores")
+            config.numCores = (unsigned) jsonUnsigned(value, key, UINT_MAX);
+        else if (key == "per_core_queues")
+            config.perCoreQueues = jsonBool(value, key);
+        else if (key == "trace")
+            config.tracePath = jobFilePath(jsonString(value, key), access, key);
+        else if (key == "levels")
+            config.feedbackLevels = (unsigned) jsonUnsigned(value, key, UINT_MAX);
+        else if (key == "level_quanta") {
+            if (value.type != JsonValue::ARRAY)
+                throw runtime_error("\"level_quanta\" must be an array of numbers");
+            config.levelQuanta.clear();
+            for (const JsonValue& quantum : value.items)
+                config.levelQuanta.push_back(jsonDouble(quantum, key));
+        }
+        else if (key == "boost_interval")
+            config.boostInterval = jsonDouble(value, key);
+        else if (key == "target_latency")
+            config.targetLatency = jsonDouble(value, key);
+        else if (key == "warmup")
+            config.deleteWarmup = jsonBool(value, key);
+        else if (key == "checkpoint")
+            config.checkpointPath = jobFilePath(jsonString(value, key), access, key);
+        else if (key == "checkpoint_at")
+            config.checkpointTime = jsonDouble(value, key);
+        else if (key == "resume")
+            config.resumePath = jobFilePath(jsonString(value, key), access, key);
+        else if (key == "reset_statistics")
+            config.resetStatistics = jsonBool(value, key);
+        else if (key == "clusters") {
+            job.cluster.numClusters = (unsigned) jsonUnsigned(value, key, UINT_MAX);
+            job.clusterModel = true;
+        }
+        else if (key == "dispatch_delay") {
+            job.cluster.dispatchDelay = jsonDouble(value, key);
+            job.clusterModel = true;
+        }
+        else if (key == "routing") {
+            const string& name = jsonString(value, key);
+            job.clusterModel = true;
+            if (name == "round-robin")
+                job.cluster.routing = ROUND_ROBIN_ROUTING;
+            else if (name == "least-loaded")
+                job.cluster.routing = LEAST_LOADED_ROUTING;
+            else
+                throw runtime_error("Invalid routing \"" + name + "\". Available choices: round-robin, least-loaded");
+        }
+        else if (key == "replications")
+            job.replication.minReplications = (unsigned) jsonUnsigned(value, key, UINT_MAX);
+        else if (key == "max_replications")
+            job.replication.maxReplications = (unsigned) jsonUnsigned(value, key, UINT_MAX);
+        else if (key == "precision")
+            job.replication.precision = jsonDouble(value, key);
+        else if (key == "confidence")
+            job.replication.confidence = jsonDouble(value, key);
+        else
+            throw runtime_error("Unknown key \"" + key + "\"");
+    }
+
+    // Replay the whole trace unless told otherwise
+    if (!config.tracePath.empty() && !numProcessesGiven)
+        config.numProcesses = INT_MAX;
+    return job;
+}
+
+/**
+ * The keys of the scalar statistics in a result, in the order of Statistics::forEachScalar().
+ */
+const char* const JSON_STATISTIC_KEYS[] {
+        "avg_turnaround_time", "throughput", "avg_cpu_util", "avg_ready_queue_size", "turnaround_time_std_dev",
+        "min_turnaround_time", "max_turnaround_time", "avg_waiting_time",
+        "turnaround_p50", "turnaround_p95", "turnaround_p99", "turnaround_p99_9",
+        "waiting_p50", "waiting_p95", "waiting_p99", "waiting_p99_9"
+};
+
+/**
+ * Appends a string to JSON text, quoted and escaped.
+ * @param out The JSON text.
+ * @param s The string.
+ */
+inline void appendJsonString(string& out, const string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char) c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", (unsigned) c);
+            out += escape;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Appends a number to JSON text, exactly (as the shortest text that reads back as the same double), or null if it
+ * isn't finite.
+ * @param out The JSON text.
+ * @param x The number.
+ */
+inline void appendJsonNumber(string& out, double x) {
+    if (!std::isfinite(x)) {
+        out += "null";
+        return;
+    }
+    char number[32];
+    for (int digits = 15; digits <= 17; digits++) {
+        snprintf(number, sizeof(number), "%.*g", digits, x);
+        if (strtod(number, nullptr) == x) break;
+    }
+    out += number;
+}
+
+/**
+ * Appends the scalar statistics of a simulation to JSON text, as an object.
+ * @param out The JSON text.
+ * @param s The statistics.
+ */
+inline void appendJsonStatistics(string& out, Statistics s) {
+    int i = 0;
+    out += '{';
+    s.forEachScalar([&](const char*, double& x) {
+        if (i > 0) out += ',';
+        appendJsonString(out, JSON_STATISTIC_KEYS[i++]);
+        out += ':';
+        appendJsonNumber(out, x);
+    });
+    out += '}';
+}
+
+/**
+ * Makes the result of a job that couldn't be run.
+ * @param id The id of the job, as JSON text.
+ * @param message The error message.
+ * @return The result, one JSON object on one line (without a newline).
+ */
+inline string jsonError(const string& id, const string& message) {
+    string out = "{\"id\":" + id + ",\"error\":";
+    appendJsonString(out, message);
+    out += '}';
+    return out;
+}
+
+/**
+ * Runs a job given as JSON (see parseJobSpec()) and returns its result as JSON: the id of the job, its seed (so a job
+ * run under a random seed can be repeated), the number of replications, the statistics (averaged over the
+ * replications), the utilization of each core, migrations and warm-up deleted, the half-widths of their confidence
+ * intervals if replicated, and the wall clock time the job took. Never throws: a job that can't be run gets a result
+ * with its error instead.
+ * @param request The job, one JSON object.
+ * @param access Which files the job may name (any by default).
+ * @return The result, one JSON object on one line (without a newline).
+ */
+inline string runJsonJob(const string& request, const JobFileAccess& access = JobFileAccess()) {
+    string id = "null";
+    try {
+        JsonValue value = JsonParser::parse(request);
+        const JsonValue* idValue = value.find("id");
+        if (idValue != nullptr) {
+            // Keep the result on one line (line breaks can only be whitespace between the id's tokens)
+            id = request.substr(idValue->begin, idValue->end - idValue->begin);
+            std::replace(id.begin(), id.end(), '\n', ' ');
+            std::replace(id.begin(), id.end(), '\r', ' ');
+        }
+        JobSpec job = parseJobSpec(value, access);
+        validateJob(job);
+
+        auto start = std::chrono::steady_clock::now();
+        ReplicatedStatistics r = simulateJob(job);
+        double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        string out = "{\"id\":" + id + ",\"seed\":" + std::to_string(job.seed) + ",\"replications\":"
+                     + std::to_string(r.replications) + ",\"statistics\":";
+        appendJsonStatistics(out, r.mean);
+        out += ",\"core_utilization\":[";
+        for (size_t i = 0; i < r.mean.coreUtilization.size(); i++) {
+            if (i > 0) out += ',';
+            appendJsonNumber(out, r.mean.coreUtilization[i]);
+        }
+        out += "],\"migrations\":" + std::to_string(r.mean.migrations) + ",\"warmup_processes\":"
+               + std::to_string(r.mean.warmupProcesses) + ",\"warmup_time\":";
+        appendJsonNumber(out, r.mean.warmupTime);
+        if (job.replication.enabled()) {
+            out += ",\"half_widths\":";
+            appendJsonStatistics(out, r.halfWidth);
+            out += ",\"converged\":";
+            out += r.converged ? "true" : "false";
+        }
+        out += ",\"wall_time\":";
+        appendJsonNumber(out, wallTime);
+        out += '}';
+        return out;
+    } catch (const std::exception& e) {
+        return jsonError(id, e.what());
+    }
+}
+
+
+#endif //CS4328_PROJECT1_JOBJSON_H
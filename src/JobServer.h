@@ -0,0 +1,243 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_JOBSERVER_H
+#define CS4328_PROJECT1_JOBSERVER_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "JobJson.h"
+#include "ThreadPool.h"
+
+using std::atomic;
+using std::condition_variable;
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+
+/**
+ * A long-running server that reads jobs as newline-delimited JSON (one job per line, see JobJson.h) and streams their
+ * results back the same way, so a script can run any number of simulations without starting the simulator for each.
+ * Jobs run in parallel on a thread pool shared by every connection, and each result is written as soon as its job
+ * finishes, so results come back in the order the jobs finish rather than the order they were sent (match them by id).
+ * Since any client can send jobs, jobs may only name files (traces and checkpoints) in the job directory the server was
+ * given, and a job longer than MAX_JOB_LENGTH is answered with an error rather than buffered.
+ */
+class JobServer {
+
+public:
+
+    // The longest job (in bytes, not counting its newline) a client may send
+    static const size_t MAX_JOB_LENGTH = 1 << 20;
+    // How long to wait (in milliseconds) before accepting again when out of file descriptors
+    static const int ACCEPT_BACKOFF_MS = 100;
+
+    /**
+     * Creates a JobServer and starts its threads.
+     * @param numThreads The number of jobs to run at once (0 for one per hardware thread).
+     * @param jobDirectory The directory jobs may name files in (empty if jobs may name no files).
+     */
+    JobServer(unsigned numThreads, const string& jobDirectory) : pool(numThreads) {
+        this->access.anyPath = false;
+        this->access.directory = jobDirectory;
+        // A client that disconnects early must only end its own connection
+        signal(SIGPIPE, SIG_IGN);
+    }
+
+    /**
+     * Serves one stream of jobs: reads jobs until the end of the input, then waits for their results to be written.
+     * @param inFd The file descriptor to read jobs from.
+     * @param outFd The file descriptor to write results to.
+     * @return False if the results couldn't all be written (the client went away), true otherwise.
+     */
+    bool serveStream(int inFd, int outFd) {
+        shared_ptr<Connection> connection = std::make_shared<Connection>();
+        connection->outFd = outFd;
+
+        string buffer;
+        // Whether the rest of a line that was too long is being skipped
+        bool skipping = false;
+        char chunk[65536];
+        while (!connection->broken) {
+            ssize_t n = read(inFd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+
+            // Submit every complete line
+            buffer.append(chunk, (size_t) n);
+            size_t start = 0;
+            for (size_t end; (end = buffer.find('\n', start)) != string::npos; start = end + 1) {
+                if (!skipping)
+                    submit(connection, buffer.substr(start, end - start));
+                skipping = false;
+            }
+            buffer.erase(0, start);
+
+            // Answer a line that is already too long right away, and skip the rest of it
+            if (buffer.size() > MAX_JOB_LENGTH) {
+                if (!skipping)
+                    respond(*connection, tooLong());
+                skipping = true;
+                buffer.clear();
+            }
+        }
+        // A last line without a newline is still a job
+        if (!skipping)
+            submit(connection, buffer);
+
+        unique_lock<mutex> lock(connection->lock);
+        connection->done.wait(lock, [&] { return connection->pending == 0; });
+        return !connection->broken;
+    }
+
+    /**
+     * Listens on a Unix domain socket and serves every connection to it as a stream of jobs, each on its own thread.
+     * Never returns unless the socket can't be set up.
+     * @param path The path of the socket (replaced if it already exists).
+     * @throws runtime_error If the socket can't be created or listened on.
+     */
+    void serveSocket(const string& path) {
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            throw runtime_error("Socket path \"" + path + "\" is too long");
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == -1)
+            throw runtime_error(string("Can't create socket: ") + strerror(errno));
+        unlink(path.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+            || listen(listener, SOMAXCONN) == -1) {
+            string error = strerror(errno);
+            close(listener);
+            throw runtime_error("Can't listen on \"" + path + "\": " + error);
+        }
+
+        while (true) {
+            int client = accept(listener, nullptr, nullptr);
+            if (client == -1) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                // Out of file descriptors: the pending connection stays queued, so wait for connections to close
+                // rather than retrying straight away
+                if (errno == EMFILE || errno == ENFILE) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(ACCEPT_BACKOFF_MS));
+                    continue;
+                }
+                string error = strerror(errno);
+                close(listener);
+                throw runtime_error("Can't accept connections on \"" + path + "\": " + error);
+            }
+            std::thread([this, client] {
+                serveStream(client, client);
+                close(client);
+            }).detach();
+        }
+    }
+
+private:
+    /**
+     * Where the results of one stream of jobs go, and how many are still to come.
+     */
+    struct Connection {
+        int outFd = -1;
+        mutex lock;
+        condition_variable done;
+        unsigned long pending = 0;
+        // Set when a result couldn't be written, after which the rest are dropped
+        atomic<bool> broken {false};
+    };
+
+    ThreadPool pool;
+    JobFileAccess access;
+
+    /**
+     * Runs a job on the thread pool and writes its result to the connection when it finishes.
+     * @param connection The connection the job came from.
+     * @param line The job (blank lines are skipped).
+     */
+    void submit(const shared_ptr<Connection>& connection, string line) {
+        if (line.find_first_not_of(" \t\r") == string::npos)
+            return;
+        if (line.size() > MAX_JOB_LENGTH) {
+            respond(*connection, tooLong());
+            return;
+        }
+        {
+            lock_guard<mutex> lock(connection->lock);
+            connection->pending++;
+        }
+        pool.submit([this, connection, line] {
+            string result = runJsonJob(line, access);
+            lock_guard<mutex> lock(connection->lock);
+            writeResult(*connection, result);
+            if (--connection->pending == 0)
+                connection->done.notify_all();
+        });
+    }
+
+    /**
+     * Writes a result to a connection right away.
+     * @param connection The connection.
+     * @param result The result, one line of JSON (without a newline).
+     */
+    static void respond(Connection& connection, const string& result) {
+        lock_guard<mutex> lock(connection.lock);
+        writeResult(connection, result);
+    }
+
+    /**
+     * Writes a result to a connection, unless it is broken, whose lock must be held.
+     * @param connection The connection.
+     * @param result The result, one line of JSON (without a newline).
+     */
+    static void writeResult(Connection& connection, const string& result) {
+        if (!connection.broken && !writeAll(connection.outFd, result + '\n'))
+            connection.broken = true;
+    }
+
+    /**
+     * Makes the result of a job that was too long to read.
+     * @return The result, one line of JSON (without a newline).
+     */
+    static string tooLong() {
+        return jsonError("null", "A job can't be longer than " + std::to_string(MAX_JOB_LENGTH) + " bytes");
+    }
+
+    /**
+     * Writes all of a string to a file descriptor.
+     * @param fd The file descriptor.
+     * @param s The string.
+     * @return True if it was all written, false on an error.
+     */
+    static bool writeAll(int fd, const string& s) {
+        for (size_t written = 0; written < s.size();) {
+            ssize_t n = write(fd, s.data() + written, s.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += (size_t) n;
+        }
+        return true;
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_JOBSERVER_H
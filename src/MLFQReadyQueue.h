@@ -0,0 +1,140 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_MLFQREADYQUEUE_H
+#define CS4328_PROJECT1_MLFQREADYQUEUE_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "Process.h"
+
+using std::deque;
+using std::vector;
+
+/**
+ * A ready queue for the multi-level feedback queue (MLFQ) scheduler: one first come first serve queue per priority
+ * level, with a process queued on the level stored in the process table. The front process is the oldest one on the
+ * highest priority level that has any, so adding and getting processes take O(1) time (plus a scan of the few levels).
+ * @tparam PriorityComparator Unused, the priority scheme is always the levels (taken so the MLFQReadyQueue can stand in
+ * for a ReadyQueue in a SchedulingPolicy).
+ * @tparam Processes The table the processes are stored in (ProcessTable or ProcessPool).
+ */
+template <class PriorityComparator, class Processes>
+class MLFQReadyQueue {
+
+public:
+
+    /**
+     * Creates an empty MLFQReadyQueue.
+     * @param table The table the processes are stored in, which must outlive the MLFQReadyQueue.
+     */
+    explicit MLFQReadyQueue(Processes& table) {
+        this->table = &table;
+        this->count = 0;
+        this->top = 0;
+    }
+
+    /**
+     * Adds a process to the back of its level's queue.
+     * @param p The process to add to the MLFQReadyQueue.
+     */
+    void add(ProcessId p) {
+        size_t level = table->getLevel(p);
+        if (level >= levels.size())
+            levels.resize(level + 1);
+        levels[level].push_back(p);
+        if (level < top)
+            top = level;
+        count++;
+    }
+
+    /**
+     * Gets the oldest process on the highest priority level and removes it from the MLFQReadyQueue.
+     * @return The process that was at the front of the MLFQReadyQueue.
+     */
+    ProcessId getFront() {
+        ProcessId p = front();
+        levels[top].pop_front();
+        count--;
+        return p;
+    }
+
+    /**
+     * Returns the oldest process on the highest priority level without removing it.
+     * @return The process at the front of the MLFQReadyQueue, which must not be empty.
+     */
+    ProcessId front() {
+        while (levels[top].empty())
+            top++;
+        return levels[top].front();
+    }
+
+    /**
+     * Calls a function with every process in the MLFQReadyQueue, in an order that adding them back to an empty
+     * MLFQReadyQueue restores it.
+     * @param function The function, called as function(ProcessId).
+     */
+    template <class Function>
+    void forEachProcess(Function&& function) const {
+        // Each level from the highest down, oldest first
+        for (const auto& level : levels)
+            for (ProcessId p : level)
+                function(p);
+    }
+
+    /**
+     * Moves every process to the highest priority level (a priority boost), keeping them in order of their old levels.
+     */
+    void boost() {
+        for (size_t level = 1; level < levels.size(); level++) {
+            for (ProcessId p : levels[level]) {
+                table->setLevel(p, 0);
+                levels[0].push_back(p);
+            }
+            levels[level].clear();
+        }
+        top = 0;
+    }
+
+    /**
+     * Does nothing, since priorities only change when a process leaves the CPU.
+     * @param clock The current clock time (in seconds).
+     */
+    void updateWaitTimes(SimTime clock) { (void) clock; }
+
+    /**
+     * Does nothing, since each level is kept in order.
+     */
+    void sort() {}
+
+    /**
+     * Determines whether the MLFQReadyQueue is empty (has no processes in it).
+     * @return True if the MLFQReadyQueue is empty, false otherwise.
+     */
+    bool empty() {
+        return count == 0;
+    }
+
+    /**
+     * Returns the size of the MLFQReadyQueue.
+     * @return The number of processes in the MLFQReadyQueue.
+     */
+    unsigned long size() {
+        return count;
+    }
+
+private:
+    Processes* table;
+    // One queue per level, from the highest priority down
+    vector<deque<ProcessId>> levels;
+    unsigned long count;
+    // No level above this one has any processes
+    size_t top;
+
+};
+
+
+#endif //CS4328_PROJECT1_MLFQREADYQUEUE_H
@@ -6,35 +6,91 @@
 #ifndef CS4328_PROJECT1_PRIORITYCOMPARATOR_H
 #define CS4328_PROJECT1_PRIORITYCOMPARATOR_H
 
-#include "Process.h"
+#include <type_traits>
+#include <utility>
+#include "ProcessTable.h"
+
+#if defined(__cpp_concepts) && __cpp_concepts >= 201907L
+#include <concepts>
 
 /**
- * An abstract base class for priority comparators for use in priority based scheduling simulations.
+ * A priority comparator must provide a static compare(processes, ProcessId, ProcessId) function returning true if the
+ * first process has higher priority than the second, looking both up in a process table.
  */
-class PriorityComparator {
+template <class Comparator>
+concept ProcessComparator = requires(const ProcessTable& processes, ProcessId p1, ProcessId p2) {
+    { Comparator::compare(processes, p1, p2) } -> std::convertible_to<bool>;
+};
+#define PRIORITY_COMPARATOR ProcessComparator
+#else
+#define PRIORITY_COMPARATOR class
+#endif
+
+/**
+ * A static interface for priority comparators for use in priority based scheduling simulations. Comparators derive
+ * from PriorityComparator<Self> and implement a static compare() function templated on the process table (ProcessTable
+ * or ProcessPool), so the same comparator works on either layout without any virtual dispatch. Ready queues keep their
+ * processes in ordered sets, which hold only one of any processes that compare equal, so comparators used to order a
+ * ready queue break every tie by process ID last (processes arriving at the same time are common in traces).
+ * @tparam Comparator The comparator deriving from this class.
+ */
+template <class Comparator>
+struct PriorityComparator {
     /**
-     * A pure virtual function that templates the comparison of two processes.
-     * @param p1 A pointer to a Process.
-     * @param p2 A pointer to a Process.
-     * @return True if p1 points to a process with higher priority than p2, false otherwise.
+     * Orders process IDs by the derived comparator's priority scheme, for use as the ordering of standard containers.
+     * @tparam Processes The table the processes are looked up in.
      */
-    virtual bool operator()(Process* p1, Process* p2) = 0;
+    template <class Processes>
+    class Ordering {
+    public:
+        explicit Ordering(const Processes* processes) : processes(processes) {}
+
+        /**
+         * Compares the priority of two processes using the derived comparator's priority scheme.
+         * @param p1 A process.
+         * @param p2 A process.
+         * @return True if p1 has higher priority than p2, false otherwise.
+         */
+        bool operator()(ProcessId p1, ProcessId p2) const {
+            return Comparator::compare(*processes, p1, p2);
+        }
+
+    private:
+        const Processes* processes;
+    };
 };
 
+/**
+ * Determines at compile time whether a type is a priority comparator, i.e. has a static
+ * compare(processes, ProcessId, ProcessId) returning bool.
+ * @tparam Comparator The type to check.
+ */
+template <class Comparator, class = void>
+struct IsPriorityComparator : std::false_type {};
+
+template <class Comparator>
+struct IsPriorityComparator<Comparator, typename std::enable_if<std::is_convertible<
+        decltype(Comparator::compare(std::declval<const ProcessTable&>(), ProcessId(), ProcessId())),
+        bool>::value>::type> : std::true_type {};
+
 /**
  * A PriorityComparator that uses the First Come First Serve (FCFS) priority scheme. A process has higher priority than another
  * if its arrival time is sooner.
  */
-class FCFSPriorityComparator : PriorityComparator {
-public:
+struct FCFSPriorityComparator : PriorityComparator<FCFSPriorityComparator> {
     /**
      * Compares the priority of two processes under First Come First Serve (FCFS).
-     * @param p1 A pointer to a Process.
-     * @param p2 A pointer to a Process.
-     * @return True if p1 points to a process with higher priority than p2, false otherwise.
+     * @param processes The table the processes are in.
+     * @param p1 A process.
+     * @param p2 A process.
+     * @return True if p1 has higher priority than p2, false otherwise.
      */
-    bool operator()(Process* p1, Process* p2) override {
-        return p1->getArrivalTime() < p2->getArrivalTime();
+    template <class Processes>
+    static bool compare(const Processes& processes, ProcessId p1, ProcessId p2) {
+        if (processes.getArrivalTime(p1) != processes.getArrivalTime(p2))
+            return processes.getArrivalTime(p1) < processes.getArrivalTime(p2);
+        else
+            return processes.getId(p1) < processes.getId(p2);
     }
 };
 
@@ -42,19 +98,22 @@ public:
  * A PriorityComparator that uses the Shortest Remaining Time First (SRTF) priority scheme. A process has higher priority than
  * another if the amount of service time it has left is smaller.
  */
-class SRTFPriorityComparator : PriorityComparator {
-public:
+struct SRTFPriorityComparator : PriorityComparator<SRTFPriorityComparator> {
     /**
      * Compares the priority of two processes under Shortest Remaining Time First (SRTF).
-     * @param p1 A pointer to a Process.
-     * @param p2 A pointer to a Process.
-     * @return True if p1 points to a process with higher priority than p2, false otherwise.
+     * @param processes The table the processes are in.
+     * @param p1 A process.
+     * @param p2 A process.
+     * @return True if p1 has higher priority than p2, false otherwise.
      */
-    bool operator()(Process* p1, Process* p2) override {
-        if (p1->getServiceTimeLeft() != p2->getServiceTimeLeft())
-            return p1->getServiceTimeLeft() < p2->getServiceTimeLeft();
+    template <class Processes>
+    static bool compare(const Processes& processes, ProcessId p1, ProcessId p2) {
+        if (processes.getServiceTimeLeft(p1) != processes.getServiceTimeLeft(p2))
+            return processes.getServiceTimeLeft(p1) < processes.getServiceTimeLeft(p2);
+        else if (processes.getArrivalTime(p1) != processes.getArrivalTime(p2))
+            return processes.getArrivalTime(p1) < processes.getArrivalTime(p2);
         else
-            return p1->getArrivalTime() < p2->getArrivalTime();
+            return processes.getId(p1) < processes.getId(p2);
     }
 };
 
@@ -62,20 +121,66 @@ public:
  * A PriorityComparator that uses the Highest Response Ratio Next (HRRN) priority scheme. A process has higher priority than
  * another if its response ratio is greater.
  */
-class HRRNPriorityComparator : PriorityComparator {
-public:
+struct HRRNPriorityComparator : PriorityComparator<HRRNPriorityComparator> {
     /**
      * Compares the priority of two processes under Highest Response Ratio Next (HRRN).
-     * @param p1 A pointer to a Process.
-     * @param p2 A pointer to a Process.
-     * @return True if p1 points to a process with higher priority than p2, false otherwise.
+     * @param processes The table the processes are in.
+     * @param p1 A process.
+     * @param p2 A process.
+     * @return True if p1 has higher priority than p2, false otherwise.
+     */
+    template <class Processes>
+    static bool compare(const Processes& processes, ProcessId p1, ProcessId p2) {
+        if (processes.calcResponseRatio(p1) != processes.calcResponseRatio(p2))
+            return processes.calcResponseRatio(p1) > processes.calcResponseRatio(p2);
+        else if (processes.getArrivalTime(p1) != processes.getArrivalTime(p2))
+            return processes.getArrivalTime(p1) < processes.getArrivalTime(p2);
+        else
+            return processes.getId(p1) < processes.getId(p2);
+    }
+};
+
+/**
+ * A PriorityComparator for the multi-level feedback queue (MLFQ) scheduler. A process has higher priority than another
+ * if it is on a higher priority level (a lower level number). Processes on the same level are equivalent: the
+ * MLFQReadyQueue keeps each level in first come first serve order, and a process only preempts one on a lower level.
+ */
+struct MLFQPriorityComparator : PriorityComparator<MLFQPriorityComparator> {
+    /**
+     * Compares the priority levels of two processes.
+     * @param processes The table the processes are in.
+     * @param p1 A process.
+     * @param p2 A process.
+     * @return True if p1 is on a higher priority level than p2, false otherwise.
+     */
+    template <class Processes>
+    static bool compare(const Processes& processes, ProcessId p1, ProcessId p2) {
+        return processes.getLevel(p1) < processes.getLevel(p2);
+    }
+};
+
+/**
+ * A PriorityComparator that uses the Completely Fair Scheduler (CFS) priority scheme. A process has higher priority
+ * than another if it has less virtual runtime (it has had less than its fair share of the CPU).
+ */
+struct CFSPriorityComparator : PriorityComparator<CFSPriorityComparator> {
+    /**
+     * Compares the priority of two processes under the Completely Fair Scheduler (CFS).
+     * @param processes The table the processes are in.
+     * @param p1 A process.
+     * @param p2 A process.
+     * @return True if p1 has higher priority than p2, false otherwise.
      */
-    bool operator()(Process* p1, Process* p2) override {
-        if (p1->calcResponseRatio() != p2->calcResponseRatio())
-            return p1->calcResponseRatio() > p2->calcResponseRatio();
+    template <class Processes>
+    static bool compare(const Processes& processes, ProcessId p1, ProcessId p2) {
+        if (processes.getVirtualRuntime(p1) != processes.getVirtualRuntime(p2))
+            return processes.getVirtualRuntime(p1) < processes.getVirtualRuntime(p2);
+        else if (processes.getArrivalTime(p1) != processes.getArrivalTime(p2))
+            return processes.getArrivalTime(p1) < processes.getArrivalTime(p2);
         else
-            return p1->getArrivalTime() < p2->getArrivalTime();
+            return processes.getId(p1) < processes.getId(p2);
     }
 };
 
+
 #endif //CS4328_PROJECT1_PRIORITYCOMPARATOR_H
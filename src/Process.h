@@ -7,9 +7,24 @@
 #define CS4328_PROJECT1_PROCESS_H
 
 #include <cmath>
+#include <cstdint>
+#include "EventHandle.h"
+#include "SimTime.h"
 
 /**
- * A class to hold information about a process.
+ * Identifies a process within the table holding it (a ProcessTable or ProcessPool). IDs are reused once a process is
+ * released, so they stay small and index straight into the table.
+ */
+typedef uint32_t ProcessId;
+
+/**
+ * An ID that doesn't refer to any process.
+ */
+const ProcessId NO_PROCESS = ~0u;
+
+/**
+ * A class to hold information about a process. Processes are stored by value in a ProcessPool; the ProcessTable stores
+ * the same fields column by column instead.
  */
 class Process {
 
@@ -21,7 +36,7 @@ public:
      * @param arrivalTime The arrival time (in seconds) of the process.
      * @param serviceTime The service time (in seconds) of the process.
      */
-    Process(int id, double arrivalTime, double serviceTime) {
+    Process(int id, SimTime arrivalTime, SimTime serviceTime) {
         this->id = id;
         this->arrivalTime = arrivalTime;
         this->serviceTime = serviceTime;
@@ -30,91 +45,135 @@ public:
         this->lastTimeAssignedCpu = -1;
         this->serviceTimeLeft = serviceTime;
         this->completionTime = -1;
+        this->departure = NO_EVENT;
+        this->level = 0;
+        this->virtualRuntime = 0;
     }
 
     /**
      * Returns the ID of this process.
      * @return The ID of this process.
      */
-    int getId() { return this->id; }
+    int getId() const { return this->id; }
 
     /**
      * Returns the arrival time of this process.
      * @return The arrival time (in seconds) of this process.
      */
-    double getArrivalTime() { return this->arrivalTime; }
+    SimTime getArrivalTime() const { return this->arrivalTime; }
 
     /**
      * Returns the service time of this process.
      * @return The service time (in seconds) of this process.
      */
-    double getServiceTime() { return this->serviceTime; }
+    SimTime getServiceTime() const { return this->serviceTime; }
 
     /**
      * Returns the current wait time of this process.
      * @return The current wait time (in seconds) of this process.
      */
-    double getWaitTime() { return this->waitTime; }
+    SimTime getWaitTime() const { return this->waitTime; }
 
     /**
      * Sets the current wait time of this process.
      * @param waitTime The new wait time (in seconds) of this process.
      */
-    void setWaitTime(double waitTime) { this->waitTime = waitTime; }
+    void setWaitTime(SimTime waitTime) { this->waitTime = waitTime; }
 
     /**
      * Returns the last time this process was assigned to the CPU.
      * @return The last time (in seconds) this process was assigned to the CPU.
      */
-    double getLastTimeAssignedCpu() { return this->lastTimeAssignedCpu; }
+    SimTime getLastTimeAssignedCpu() const { return this->lastTimeAssignedCpu; }
 
     /**
      * Sets the last time this process was assigned the CPU.
      * @param lastTimeOnCpu The time (in seconds) this process was assigned the CPU.
      */
-    void setLastTimeAssignedCpu(double lastTimeOnCpu) { this->lastTimeAssignedCpu = lastTimeOnCpu; }
+    void setLastTimeAssignedCpu(SimTime lastTimeOnCpu) { this->lastTimeAssignedCpu = lastTimeOnCpu; }
 
     /**
      * Returns the service time this process has left.
      * @return The service time (in seconds) this process has left.
      */
-    double getServiceTimeLeft() { return this->serviceTimeLeft; }
+    SimTime getServiceTimeLeft() const { return this->serviceTimeLeft; }
 
     /**
      * Sets the amount of time left this process needs on the CPU.
      * @param serviceTimeLeft The amount of time (in seconds) this process still needs on the CPU.
      */
-    void setServiceTimeLeft(double serviceTimeLeft) { this->serviceTimeLeft = serviceTimeLeft; }
+    void setServiceTimeLeft(SimTime serviceTimeLeft) { this->serviceTimeLeft = serviceTimeLeft; }
 
     /**
      * Returns the completion time of this process.
      * @return The completion time (in seconds) of this process.
      */
-    double getCompletionTime() { return this->completionTime; }
+    SimTime getCompletionTime() const { return this->completionTime; }
 
     /**
      * Sets the completion time of the process
      * @param completionTime The completion time (in seconds) of the process.
      */
-    void setCompletionTime(double completionTime) { this->completionTime = completionTime; }
+    void setCompletionTime(SimTime completionTime) { this->completionTime = completionTime; }
+
+    /**
+     * Returns the handle of this process' tentative departure event.
+     * @return The handle of the departure event, or NO_EVENT if no departure is scheduled.
+     */
+    EventHandle getDeparture() const { return this->departure; }
+
+    /**
+     * Sets the handle of this process' tentative departure event.
+     * @param departure The handle of the departure event, or NO_EVENT if no departure is scheduled.
+     */
+    void setDeparture(EventHandle departure) { this->departure = departure; }
+
+    /**
+     * Returns the priority level of this process, used in the MLFQ scheduler.
+     * @return The priority level of this process (0 is the highest).
+     */
+    unsigned getLevel() const { return this->level; }
+
+    /**
+     * Sets the priority level of this process.
+     * @param level The new priority level of this process (0 is the highest).
+     */
+    void setLevel(unsigned level) { this->level = level; }
+
+    /**
+     * Returns the virtual runtime of this process, used in the CFS scheduler.
+     * @return The virtual runtime (in seconds) of this process.
+     */
+    SimTime getVirtualRuntime() const { return this->virtualRuntime; }
+
+    /**
+     * Sets the virtual runtime of this process.
+     * @param virtualRuntime The new virtual runtime (in seconds) of this process.
+     */
+    void setVirtualRuntime(SimTime virtualRuntime) { this->virtualRuntime = virtualRuntime; }
 
     /**
      * Calculates the response ratio of the process, used in the HRRN scheduler.
      * @return The response ratio of the process.
      */
-    double calcResponseRatio() {
-        return (this->waitTime + this->serviceTime) / this->serviceTime;
+    double calcResponseRatio() const {
+        return (double) (this->waitTime + this->serviceTime) / this->serviceTime;
     }
 
 private:
     int id;
-    double arrivalTime;
-    double serviceTime;
+    SimTime arrivalTime;
+    SimTime serviceTime;
+
+    SimTime waitTime;
+    SimTime lastTimeAssignedCpu;
+    SimTime serviceTimeLeft;
+    SimTime completionTime;
+
+    EventHandle departure;
 
-    double waitTime;
-    double lastTimeAssignedCpu;
-    double serviceTimeLeft;
-    double completionTime;
+    unsigned level;
+    SimTime virtualRuntime;
 
 };
 
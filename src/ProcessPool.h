@@ -0,0 +1,120 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_PROCESSPOOL_H
+#define CS4328_PROJECT1_PROCESSPOOL_H
+
+#include <cstddef>
+#include <vector>
+#include "Process.h"
+
+using std::vector;
+
+/**
+ * A per-simulation pool of Process objects, stored by value in one array and indexed by ProcessId. A released
+ * process' slot goes on a free list to be reused by the next process acquired. Since a simulation releases every
+ * process once it departs, the memory used tracks the number of processes alive at once rather than the total number
+ * simulated.
+ *
+ * The interface matches ProcessTable, which stores the same fields as a structure of arrays instead. The pool is used
+ * when the simulator is built with SCHEDSIM_AOS_PROCESSES defined.
+ */
+class ProcessPool {
+
+public:
+
+    /**
+     * Creates an empty ProcessPool.
+     */
+    ProcessPool() {
+        this->live = 0;
+    }
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    /**
+     * Creates a Process in the ProcessPool, reusing a released slot if possible.
+     * @param id The ID of the process (its number in the simulation).
+     * @param arrivalTime The arrival time (in seconds) of the process.
+     * @param serviceTime The service time (in seconds) of the process.
+     * @return The process' ID in the pool, valid until it is released.
+     */
+    ProcessId acquire(int id, SimTime arrivalTime, SimTime serviceTime) {
+        ProcessId p;
+        if (!freeSlots.empty()) {
+            p = freeSlots.back();
+            freeSlots.pop_back();
+            slots[p] = Process(id, arrivalTime, serviceTime);
+        } else {
+            p = (ProcessId) slots.size();
+            slots.emplace_back(id, arrivalTime, serviceTime);
+        }
+        live++;
+        return p;
+    }
+
+    /**
+     * Returns a process' slot to the ProcessPool. The ID must not be used afterwards.
+     * @param p The process to release.
+     */
+    void release(ProcessId p) {
+        freeSlots.push_back(p);
+        live--;
+    }
+
+    /**
+     * Returns the number of processes currently acquired from the ProcessPool.
+     * @return The number of live processes.
+     */
+    size_t size() const { return live; }
+
+    /**
+     * Returns the number of processes the ProcessPool has room for without growing.
+     * @return The number of slots allocated.
+     */
+    size_t capacity() const { return slots.size(); }
+
+    int getId(ProcessId p) const { return slots[p].getId(); }
+    SimTime getArrivalTime(ProcessId p) const { return slots[p].getArrivalTime(); }
+    SimTime getServiceTime(ProcessId p) const { return slots[p].getServiceTime(); }
+
+    SimTime getWaitTime(ProcessId p) const { return slots[p].getWaitTime(); }
+    void setWaitTime(ProcessId p, SimTime waitTime) { slots[p].setWaitTime(waitTime); }
+
+    SimTime getLastTimeAssignedCpu(ProcessId p) const { return slots[p].getLastTimeAssignedCpu(); }
+    void setLastTimeAssignedCpu(ProcessId p, SimTime time) { slots[p].setLastTimeAssignedCpu(time); }
+
+    SimTime getServiceTimeLeft(ProcessId p) const { return slots[p].getServiceTimeLeft(); }
+    void setServiceTimeLeft(ProcessId p, SimTime serviceTimeLeft) { slots[p].setServiceTimeLeft(serviceTimeLeft); }
+
+    SimTime getCompletionTime(ProcessId p) const { return slots[p].getCompletionTime(); }
+    void setCompletionTime(ProcessId p, SimTime completionTime) { slots[p].setCompletionTime(completionTime); }
+
+    EventHandle getDeparture(ProcessId p) const { return slots[p].getDeparture(); }
+    void setDeparture(ProcessId p, EventHandle departure) { slots[p].setDeparture(departure); }
+
+    unsigned getLevel(ProcessId p) const { return slots[p].getLevel(); }
+    void setLevel(ProcessId p, unsigned level) { slots[p].setLevel(level); }
+
+    SimTime getVirtualRuntime(ProcessId p) const { return slots[p].getVirtualRuntime(); }
+    void setVirtualRuntime(ProcessId p, SimTime virtualRuntime) { slots[p].setVirtualRuntime(virtualRuntime); }
+
+    /**
+     * Calculates the response ratio of a process, used in the HRRN scheduler.
+     * @param p The process.
+     * @return The response ratio of the process.
+     */
+    double calcResponseRatio(ProcessId p) const { return slots[p].calcResponseRatio(); }
+
+private:
+    vector<Process> slots;
+    vector<ProcessId> freeSlots;
+    size_t live;
+
+};
+
+
+#endif //CS4328_PROJECT1_PROCESSPOOL_H
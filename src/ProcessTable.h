@@ -0,0 +1,151 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_PROCESSTABLE_H
+#define CS4328_PROJECT1_PROCESSTABLE_H
+
+#include <cstddef>
+#include <vector>
+#include "Process.h"
+
+using std::vector;
+
+/**
+ * A per-simulation table of processes stored as a structure of arrays: each field of every process lives in its own
+ * contiguous array, indexed by the process' ProcessId. Comparing two processes by arrival time or remaining service
+ * time only touches the one array the comparison needs, so a ready queue full of IDs sorts through densely packed
+ * times instead of chasing a pointer to a separate object per process. A released process' ID goes on a free list to
+ * be reused by the next process acquired, so the arrays stay as long as the most processes alive at once.
+ *
+ * The interface matches ProcessPool, which stores the same fields as an array of Process objects instead.
+ */
+class ProcessTable {
+
+public:
+
+    /**
+     * Creates an empty ProcessTable.
+     */
+    ProcessTable() {
+        this->live = 0;
+    }
+
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+
+    /**
+     * Adds a process to the ProcessTable, reusing a released ID if possible.
+     * @param id The ID of the process (its number in the simulation).
+     * @param arrivalTime The arrival time (in seconds) of the process.
+     * @param serviceTime The service time (in seconds) of the process.
+     * @return The process' ID in the table, valid until it is released.
+     */
+    ProcessId acquire(int id, SimTime arrivalTime, SimTime serviceTime) {
+        ProcessId p;
+        if (!freeIds.empty()) {
+            p = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            p = (ProcessId) ids.size();
+            ids.push_back(0);
+            arrivalTimes.push_back(0);
+            serviceTimes.push_back(0);
+            waitTimes.push_back(0);
+            lastTimesAssignedCpu.push_back(0);
+            serviceTimesLeft.push_back(0);
+            completionTimes.push_back(0);
+            departures.push_back(NO_EVENT);
+            levels.push_back(0);
+            virtualRuntimes.push_back(0);
+        }
+
+        ids[p] = id;
+        arrivalTimes[p] = arrivalTime;
+        serviceTimes[p] = serviceTime;
+        waitTimes[p] = 0;
+        lastTimesAssignedCpu[p] = -1;
+        serviceTimesLeft[p] = serviceTime;
+        completionTimes[p] = -1;
+        departures[p] = NO_EVENT;
+        levels[p] = 0;
+        virtualRuntimes[p] = 0;
+        live++;
+        return p;
+    }
+
+    /**
+     * Releases a process so its ID can be reused. The ID must not be used afterwards.
+     * @param p The process to release.
+     */
+    void release(ProcessId p) {
+        freeIds.push_back(p);
+        live--;
+    }
+
+    /**
+     * Returns the number of processes currently in the ProcessTable.
+     * @return The number of live processes.
+     */
+    size_t size() const { return live; }
+
+    /**
+     * Returns the number of processes the ProcessTable has room for without growing.
+     * @return The number of IDs allocated.
+     */
+    size_t capacity() const { return ids.size(); }
+
+    int getId(ProcessId p) const { return ids[p]; }
+    SimTime getArrivalTime(ProcessId p) const { return arrivalTimes[p]; }
+    SimTime getServiceTime(ProcessId p) const { return serviceTimes[p]; }
+
+    SimTime getWaitTime(ProcessId p) const { return waitTimes[p]; }
+    void setWaitTime(ProcessId p, SimTime waitTime) { waitTimes[p] = waitTime; }
+
+    SimTime getLastTimeAssignedCpu(ProcessId p) const { return lastTimesAssignedCpu[p]; }
+    void setLastTimeAssignedCpu(ProcessId p, SimTime time) { lastTimesAssignedCpu[p] = time; }
+
+    SimTime getServiceTimeLeft(ProcessId p) const { return serviceTimesLeft[p]; }
+    void setServiceTimeLeft(ProcessId p, SimTime serviceTimeLeft) { serviceTimesLeft[p] = serviceTimeLeft; }
+
+    SimTime getCompletionTime(ProcessId p) const { return completionTimes[p]; }
+    void setCompletionTime(ProcessId p, SimTime completionTime) { completionTimes[p] = completionTime; }
+
+    EventHandle getDeparture(ProcessId p) const { return departures[p]; }
+    void setDeparture(ProcessId p, EventHandle departure) { departures[p] = departure; }
+
+    unsigned getLevel(ProcessId p) const { return levels[p]; }
+    void setLevel(ProcessId p, unsigned level) { levels[p] = level; }
+
+    SimTime getVirtualRuntime(ProcessId p) const { return virtualRuntimes[p]; }
+    void setVirtualRuntime(ProcessId p, SimTime virtualRuntime) { virtualRuntimes[p] = virtualRuntime; }
+
+    /**
+     * Calculates the response ratio of a process, used in the HRRN scheduler.
+     * @param p The process.
+     * @return The response ratio of the process.
+     */
+    double calcResponseRatio(ProcessId p) const {
+        return (double) (waitTimes[p] + serviceTimes[p]) / serviceTimes[p];
+    }
+
+private:
+    vector<int> ids;
+    vector<SimTime> arrivalTimes;
+    vector<SimTime> serviceTimes;
+    vector<SimTime> waitTimes;
+    vector<SimTime> lastTimesAssignedCpu;
+    vector<SimTime> serviceTimesLeft;
+    vector<SimTime> completionTimes;
+    vector<EventHandle> departures;
+    vector<unsigned> levels;
+    vector<SimTime> virtualRuntimes;
+
+    vector<ProcessId> freeIds;
+    size_t live;
+
+};
+
+
+#endif //CS4328_PROJECT1_PROCESSTABLE_H
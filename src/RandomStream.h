@@ -0,0 +1,498 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_RANDOMSTREAM_H
+#define CS4328_PROJECT1_RANDOMSTREAM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "Checkpoint.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(SCHEDSIM_SCALAR_RNG)
+#include <immintrin.h>
+#define SCHEDSIM_AVX2_RNG
+#endif
+
+using std::random_device;
+using std::vector;
+
+/*
+ * The random numbers come from Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"), a
+ * counter-based generator: the n-th block of four 32-bit numbers of a stream is a keyed bijection of n, so streams need
+ * no state besides a position, any number of them can be drawn from in parallel, and jumping ahead is free. Every block
+ * gives two uniform numbers with 52 random bits each. Exponential variates are generated in batches, four blocks at a
+ * time with AVX2 where the CPU has it, with a logarithm (below) that gives the same result bit for bit in the vector
+ * and the scalar code. Building with SCHEDSIM_SCALAR_RNG defined leaves the AVX2 code out.
+ */
+
+// Fused multiply-adds would round differently in the vector and scalar code, so none are contracted in either
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace philox {
+
+// The multipliers and key increments of Philox4x32
+const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+const int ROUNDS = 10;
+
+// Bits of the double 1.0, and of the mantissa
+const uint64_t ONE_BITS = 0x3FF0000000000000ul;
+const uint64_t MANTISSA_BITS = 0x000FFFFFFFFFFFFFul;
+// ln(2) split into a part with trailing zeros (so multiplying it by an exponent is exact) and the rest
+const double LN2_HI = 6.93147180369123816490e-01;
+const double LN2_LO = 1.90821492927058770002e-10;
+const double SQRT2 = 1.41421356237309504880;
+
+/**
+ * Generates one block of a Philox4x32-10 stream.
+ * @param key The key (the seed).
+ * @param block The block's position in the stream (the low half of the counter).
+ * @param stream Which stream of the key (the high half of the counter).
+ * @param out Set to the block's four numbers.
+ */
+inline void block(uint64_t key, uint64_t block, uint64_t stream, uint32_t out[4]) {
+    uint32_t x0 = (uint32_t) block, x1 = (uint32_t) (block >> 32u);
+    uint32_t x2 = (uint32_t) stream, x3 = (uint32_t) (stream >> 32u);
+    uint32_t k0 = (uint32_t) key, k1 = (uint32_t) (key >> 32u);
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t p0 = (uint64_t) M0 * x0, p1 = (uint64_t) M1 * x2;
+        x0 = (uint32_t) (p1 >> 32u) ^ x1 ^ k0;
+        x1 = (uint32_t) p1;
+        x2 = (uint32_t) (p0 >> 32u) ^ x3 ^ k1;
+        x3 = (uint32_t) p0;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = x0;
+    out[1] = x1;
+    out[2] = x2;
+    out[3] = x3;
+}
+
+/**
+ * Turns two 32-bit numbers into a uniformly distributed number in [1,2), by filling the mantissa of a double with their
+ * top 52 bits.
+ * @param low The low half of the random bits.
+ * @param high The high half of the random bits.
+ * @return A number in [1,2).
+ */
+inline double toOneTwo(uint32_t low, uint32_t high) {
+    uint64_t bits = ((((uint64_t) high << 32u) | low) >> 12u) | ONE_BITS;
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+/**
+ * Calculates the natural logarithm of a number in (0,1]: the number is split into 2^e * m with m in
+ * [sqrt(2)/2,sqrt(2)), and log(m) = 2 atanh(s), s = (m - 1) / (m + 1), is summed as an odd series in s to within a
+ * couple of ulps. The vector version does exactly the same operations in the same order.
+ * @param v The number, in (0,1].
+ * @return The natural logarithm of v.
+ */
+inline double log(double v) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    double e = (double) (int64_t) (bits >> 52u) - 1023;
+    uint64_t mantissa = (bits & MANTISSA_BITS) | ONE_BITS;
+    double m;
+    memcpy(&m, &mantissa, sizeof(m));
+    if (m > SQRT2) {
+        m = m * 0.5;
+        e = e + 1;
+    }
+
+    double f = m - 1;
+    double s = f / (2 + f);
+    double z = s * s;
+    double r = 1.0 / 21;
+    for (double c : {1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3})
+        r = r * z + c;
+    r = r * z;
+    double twoS = s + s;
+    return e * LN2_HI + (twoS + (twoS * r + e * LN2_LO));
+}
+
+#ifdef SCHEDSIM_AVX2_RNG
+
+/**
+ * Calculates the natural logarithm of four numbers in (0,1], exactly as log(double) does.
+ * @param v The numbers, in (0,1].
+ * @return Their natural logarithms.
+ */
+__attribute__((target("avx2"))) inline __m256d log4(__m256d v) {
+    const __m256d one = _mm256_set1_pd(1);
+    __m256i bits = _mm256_castpd_si256(v);
+    // The exponent field as a double, by placing it in the mantissa of 2^52 (the number is positive, so it's all of
+    // the top bits)
+    __m256d exponentField = _mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000l))),
+            _mm256_set1_pd(4503599627370496.0));
+    __m256d e = _mm256_sub_pd(exponentField, _mm256_set1_pd(1023));
+    __m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi64x((long long) MANTISSA_BITS));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(mantissa, _mm256_set1_epi64x((long long) ONE_BITS)));
+    __m256d large = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), large);
+    e = _mm256_blendv_pd(e, _mm256_add_pd(e, one), large);
+
+    __m256d f = _mm256_sub_pd(m, one);
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(_mm256_set1_pd(2), f));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d r = _mm256_set1_pd(1.0 / 21);
+    for (double c : {1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11, 1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3})
+        r = _mm256_add_pd(_mm256_mul_pd(r, z), _mm256_set1_pd(c));
+    r = _mm256_mul_pd(r, z);
+    __m256d twoS = _mm256_add_pd(s, s);
+    return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(LN2_HI)),
+                         _mm256_add_pd(twoS, _mm256_add_pd(_mm256_mul_pd(twoS, r),
+                                                           _mm256_mul_pd(e, _mm256_set1_pd(LN2_LO)))));
+}
+
+/**
+ * Generates the exponential variates of whole groups of four blocks with AVX2: the four blocks are run through the
+ * rounds side by side, one 32-bit word of each per 64-bit lane, so the 32x32->64 bit multiplies are single
+ * instructions.
+ * @param key The key (the seed).
+ * @param stream Which stream of the key.
+ * @param first The position of the first block.
+ * @param groups The number of groups of four blocks.
+ * @param scale The multiplier of the logarithms (minus the mean).
+ * @param out The buffer to fill with 8 variates per group.
+ */
+__attribute__((target("avx2"))) inline void exponentialGroups4(uint64_t key, uint64_t stream, uint64_t first,
+                                                                size_t groups, double scale, double* out) {
+    const __m256i low = _mm256_set1_epi64x(0xFFFFFFFFl);
+    const __m256i m0 = _mm256_set1_epi64x(M0), m1 = _mm256_set1_epi64x(M1);
+    const __m256i x2Start = _mm256_set1_epi64x((uint32_t) stream);
+    const __m256i x3Start = _mm256_set1_epi64x((uint32_t) (stream >> 32u));
+    const __m256i oneBits = _mm256_set1_epi64x((long long) ONE_BITS);
+    const __m256d two = _mm256_set1_pd(2), scales = _mm256_set1_pd(scale);
+
+    for (size_t g = 0; g < groups; g++) {
+        uint64_t b = first + 4 * g;
+        __m256i x0 = _mm256_set_epi64x((uint32_t) (b + 3), (uint32_t) (b + 2), (uint32_t) (b + 1), (uint32_t) b);
+        __m256i x1 = _mm256_set_epi64x((uint32_t) ((b + 3) >> 32u), (uint32_t) ((b + 2) >> 32u),
+                                       (uint32_t) ((b + 1) >> 32u), (uint32_t) (b >> 32u));
+        __m256i x2 = x2Start, x3 = x3Start;
+        uint32_t k0 = (uint32_t) key, k1 = (uint32_t) (key >> 32u);
+        for (int r = 0; r < ROUNDS; r++) {
+            __m256i p0 = _mm256_mul_epu32(x0, m0), p1 = _mm256_mul_epu32(x2, m1);
+            __m256i y0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), x1), _mm256_set1_epi64x(k0));
+            __m256i y2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), x3), _mm256_set1_epi64x(k1));
+            x1 = _mm256_and_si256(p1, low);
+            x3 = _mm256_and_si256(p0, low);
+            x0 = y0;
+            x2 = y2;
+            k0 += W0;
+            k1 += W1;
+        }
+
+        // Two numbers in [1,2) per block, as in toOneTwo(), then the variates -log(2 - x) * mean
+        __m256d first01 = _mm256_castsi256_pd(_mm256_or_si256(
+                _mm256_srli_epi64(_mm256_or_si256(_mm256_slli_epi64(x1, 32), x0), 12), oneBits));
+        __m256d second23 = _mm256_castsi256_pd(_mm256_or_si256(
+                _mm256_srli_epi64(_mm256_or_si256(_mm256_slli_epi64(x3, 32), x2), 12), oneBits));
+        __m256d a = _mm256_mul_pd(log4(_mm256_sub_pd(two, first01)), scales);
+        __m256d c = _mm256_mul_pd(log4(_mm256_sub_pd(two, second23)), scales);
+
+        // Interleave back into stream order: the first then the second number of each block
+        __m256d lo = _mm256_unpacklo_pd(a, c), hi = _mm256_unpackhi_pd(a, c);
+        _mm256_storeu_pd(out + 8 * g, _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(out + 8 * g + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+}
+
+#endif
+
+/**
+ * Generates the exponential variates of whole blocks, using AVX2 when the CPU has it.
+ * @param key The key (the seed).
+ * @param stream Which stream of the key.
+ * @param first The position of the first block.
+ * @param blocks The number of blocks.
+ * @param scale The multiplier of the logarithms (minus the mean).
+ * @param out The buffer to fill with 2 variates per block.
+ */
+inline void exponentialBlocks(uint64_t key, uint64_t stream, uint64_t first, size_t blocks, double scale,
+                              double* out) {
+    size_t done = 0;
+#ifdef SCHEDSIM_AVX2_RNG
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        exponentialGroups4(key, stream, first, blocks / 4, scale, out);
+        done = blocks / 4 * 4;
+    }
+#endif
+    for (; done < blocks; done++) {
+        uint32_t x[4];
+        block(key, first + done, stream, x);
+        out[2 * done] = log(2 - toOneTwo(x[0], x[1])) * scale;
+        out[2 * done + 1] = log(2 - toOneTwo(x[2], x[3])) * scale;
+    }
+}
+
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC pop_options
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT ON
+#endif
+
+/**
+ * A stream of random numbers for a single simulation, one of many Philox streams under the same seed. Streams are
+ * identified by a 64-bit number (see streamId()), so every simulation of a sweep or replication gets a stream that
+ * provably never overlaps another's, and two streams created with the same seed and stream number produce exactly the
+ * same sequence of numbers.
+ */
+class RandomStream {
+
+public:
+
+    /**
+     * Creates a RandomStream at the start of one of the seed's streams.
+     * @param seed The seed (the generator's key).
+     * @param stream Which of the seed's streams to draw from.
+     */
+    explicit RandomStream(unsigned long seed, unsigned long stream = 0) {
+        this->seed = seed;
+        this->stream = stream;
+        this->position = 0;
+        this->cachedBlock = UINT64_MAX;
+    }
+
+    /**
+     * Generates a seed from the system's entropy source, for runs that don't need to be reproducible.
+     * @return A non-deterministic seed.
+     */
+    static unsigned long randomSeed() {
+        random_device rd;
+        return ((unsigned long) rd() << 32u) ^ rd();
+    }
+
+    /**
+     * Numbers the stream of one simulation in a sweep by which scheduler, arrival rate and replication it is for, so
+     * every simulation gets its own stream no matter which order the simulations are run in.
+     * @param scheduler The index of the scheduler (below 65536).
+     * @param arrivalRate The index of the arrival rate (below 65536).
+     * @param replication The number of the replication, from 0.
+     * @return The stream's number.
+     */
+    static unsigned long streamId(unsigned scheduler, unsigned arrivalRate, unsigned replication) {
+        return (unsigned long) scheduler << 48u | (unsigned long) arrivalRate << 32u | replication;
+    }
+
+    /**
+     * Returns the seed this stream was created with.
+     * @return The seed of this stream.
+     */
+    unsigned long getSeed() { return this->seed; }
+
+    /**
+     * Returns the number of this stream among the seed's streams.
+     * @return The stream's number.
+     */
+    unsigned long getStream() { return this->stream; }
+
+    /**
+     * Writes the stream's seed, number and position to a checkpoint.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        out.put((uint64_t) seed);
+        out.put((uint64_t) stream);
+        out.put(position);
+    }
+
+    /**
+     * Moves the stream to where a checkpoint left it, so it goes on with exactly the numbers it would have drawn.
+     * @param in The checkpoint to read from.
+     */
+    void load(CheckpointReader& in) {
+        seed = (unsigned long) in.get<uint64_t>();
+        stream = (unsigned long) in.get<uint64_t>();
+        position = in.get<uint64_t>();
+        cachedBlock = UINT64_MAX;
+    }
+
+    /**
+     * Jumps ahead in the stream, as if that many numbers were drawn.
+     * @param count The number of random numbers to skip.
+     */
+    void skip(unsigned long count) {
+        position += count;
+    }
+
+    /**
+     * Generates a random number [0,1) following a uniform distribution.
+     * @return A uniformly distributed random number.
+     */
+    double uniform() {
+        return nextOneTwo() - 1;
+    }
+
+    /**
+     * Uses the inverse of the cumulative distribution function for an exponential distribution to translate a random
+     * number [0,1) following a uniform distribution into a random number following an exponential distribution (the
+     * distribution of the time between events in a poisson process). In the context of schedulers, it generates
+     * inter-arrival times or service times following an average rate given.
+     * @param rate The average rate of arrival or service.
+     * @return A random number following an exponential distribution given the rate.
+     */
+    double exponential(double rate) {
+        return philox::log(2 - nextOneTwo()) * (-1 / rate);
+    }
+
+    /**
+     * Fills a buffer with exponentially distributed random numbers in one go, the same numbers as calling
+     * exponential() for each.
+     * @param rate The average rate of arrival or service.
+     * @param out The buffer to fill.
+     * @param n The number of random numbers to generate.
+     */
+    void fillExponential(double rate, double* out, size_t n) {
+        size_t i = 0;
+        // Finish the block in progress, then generate whole blocks at a time
+        if (n > 0 && position % 2 == 1)
+            out[i++] = exponential(rate);
+        size_t blocks = (n - i) / 2;
+        philox::exponentialBlocks(seed, stream, position / 2, blocks, -1 / rate, out + i);
+        position += 2 * blocks;
+        i += 2 * blocks;
+        if (i < n)
+            out[i] = exponential(rate);
+    }
+
+private:
+    unsigned long seed;
+    unsigned long stream;
+    // The position of the next number in the stream (two per block)
+    uint64_t position;
+    // The last block generated by a single draw, as two numbers in [1,2)
+    uint64_t cachedBlock;
+    double cached[2];
+
+    /**
+     * Draws the next number of the stream, as a number in [1,2).
+     * @return The next number, plus 1.
+     */
+    double nextOneTwo() {
+        uint64_t b = position / 2;
+        if (b != cachedBlock) {
+            uint32_t x[4];
+            philox::block(seed, b, stream, x);
+            cached[0] = philox::toOneTwo(x[0], x[1]);
+            cached[1] = philox::toOneTwo(x[2], x[3]);
+            cachedBlock = b;
+        }
+        return cached[position++ % 2];
+    }
+
+};
+
+/**
+ * Generates pairs of inter-arrival and service times for a simulation. Rather than drawing two numbers for every
+ * process, the numbers are generated a batch at a time and handed out from a buffer.
+ */
+class VariateBuffer {
+
+public:
+
+    // The number of inter-arrival and service times generated at a time by default
+    static const size_t DEFAULT_BATCH_SIZE = 256;
+
+    /**
+     * Creates a VariateBuffer drawing from the given stream.
+     * @param rng The stream to draw random numbers from.
+     * @param arrivalRate The average arrival rate (in processes/second).
+     * @param serviceTime The average service time (in seconds).
+     * @param batchSize The number of inter-arrival and service times to generate at a time.
+     */
+    VariateBuffer(RandomStream& rng, double arrivalRate, double serviceTime, size_t batchSize = DEFAULT_BATCH_SIZE)
+            : rng(rng), interArrivalTimes(batchSize), serviceTimes(batchSize) {
+        this->arrivalRate = arrivalRate;
+        this->serviceRate = 1 / serviceTime;
+        this->index = batchSize;
+    }
+
+    /**
+     * Returns the next pair of inter-arrival and service times.
+     * @param interArrivalTime Set to the time (in seconds) between the previous arrival and the next.
+     * @param serviceTime Set to the service time (in seconds) of the next process.
+     */
+    void next(double& interArrivalTime, double& serviceTime) {
+        if (index == interArrivalTimes.size()) refill();
+        interArrivalTime = interArrivalTimes[index];
+        serviceTime = serviceTimes[index];
+        index++;
+    }
+
+    /**
+     * Writes the buffer to a checkpoint: the rates, the stream's position, and the times generated but not handed
+     * out yet.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        out.put(arrivalRate);
+        out.put(serviceRate);
+        rng.save(out);
+        out.putVector(vector<double>(interArrivalTimes.begin() + index, interArrivalTimes.end()));
+        out.putVector(vector<double>(serviceTimes.begin() + index, serviceTimes.end()));
+    }
+
+    /**
+     * Reads the buffer (and its stream) back from a checkpoint, so it hands out exactly the times it would have.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint's times were generated at another arrival rate or service time, or the
+     * checkpoint is inconsistent.
+     */
+    void load(CheckpointReader& in) {
+        if (in.get<double>() != arrivalRate || in.get<double>() != serviceRate)
+            throw std::runtime_error("The checkpoint's processes were generated with a different arrival rate or "
+                                     "service time");
+        rng.load(in);
+        vector<double> pendingInterArrivals, pendingServices;
+        in.getVector(pendingInterArrivals);
+        in.getVector(pendingServices);
+        if (pendingInterArrivals.size() != pendingServices.size() || pendingServices.size() > serviceTimes.size())
+            in.fail();
+        index = serviceTimes.size() - pendingServices.size();
+        std::copy(pendingInterArrivals.begin(), pendingInterArrivals.end(), interArrivalTimes.begin() + index);
+        std::copy(pendingServices.begin(), pendingServices.end(), serviceTimes.begin() + index);
+    }
+
+private:
+    RandomStream& rng;
+    double arrivalRate;
+    double serviceRate;
+
+    vector<double> interArrivalTimes;
+    vector<double> serviceTimes;
+    size_t index;
+
+    /**
+     * Generates the next batch of inter-arrival and service times.
+     */
+    void refill() {
+        rng.fillExponential(arrivalRate, interArrivalTimes.data(), interArrivalTimes.size());
+        rng.fillExponential(serviceRate, serviceTimes.data(), serviceTimes.size());
+        index = 0;
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_RANDOMSTREAM_H
@@ -6,24 +6,34 @@
 #ifndef CS4328_PROJECT1_READYQUEUE_H
 #define CS4328_PROJECT1_READYQUEUE_H
 
+#include <set>
 #include "Process.h"
 
+using std::set;
+
 /**
  * A class to hold Processes in a queue-like structure using a specified priority comparator to control the processes'
- * ordering.
- * @tparam PriorityComparator The comparator to use for sorting the processes in the queue. Must implement operator()
- * to specify the priority scheme.
+ * ordering. The queue holds process IDs, and the comparator looks up the fields it orders by in the process table.
+ * @tparam PriorityComparator The comparator to use for sorting the processes in the queue. Must derive from
+ * ::PriorityComparator to specify the priority scheme.
+ * @tparam Processes The table the processes are stored in (ProcessTable or ProcessPool).
  */
-template <class PriorityComparator>
+template <class PriorityComparator, class Processes>
 class ReadyQueue {
 
 public:
 
+    /**
+     * Creates an empty ReadyQueue.
+     * @param table The table the processes are stored in, which must outlive the ReadyQueue.
+     */
+    explicit ReadyQueue(Processes& table) : table(&table), processes(Ordering(&table)) {}
+
     /**
      * Adds a process to the ReadyQueue in the correct position based on its priority.
      * @param p The process to add to the ReadyQueue.
      */
-    void add(Process* p) {
+    void add(ProcessId p) {
         processes.insert(p);
     }
 
@@ -31,32 +41,51 @@ public:
      * Gets the process in the front of the ReadyQueue and removes it from the ReadyQueue.
      * @return The process that was at the front of the ReadyQueue.
      */
-    Process* getFront() {
-        Process* p = *processes.begin();
-        processes.erase(p);
+    ProcessId getFront() {
+        ProcessId p = *processes.begin();
+        processes.erase(processes.begin());
         return p;
     }
 
+    /**
+     * Returns the process in the front of the ReadyQueue without removing it.
+     * @return The process at the front of the ReadyQueue, which must not be empty.
+     */
+    ProcessId front() {
+        return *processes.begin();
+    }
+
     /**
      * Returns the processes in the ReadyQueue as a set.
      * @return The processes in the ReadyQueue.
      */
-    const set<Process*, PriorityComparator> getProcesses() {
+    const set<ProcessId, typename PriorityComparator::template Ordering<Processes>>& getProcesses() {
         return processes;
     }
 
+    /**
+     * Calls a function with every process in the ReadyQueue, in an order that adding them back to an empty ReadyQueue
+     * restores it.
+     * @param function The function, called as function(ProcessId).
+     */
+    template <class Function>
+    void forEachProcess(Function&& function) const {
+        for (ProcessId p : processes)
+            function(p);
+    }
+
     /**
      * Updates the wait time of each process in the ReadyQueue.
      * @param clock The current clock time (in seconds).
      */
-    void updateWaitTimes(double clock) {
-        for (auto process : this->getProcesses()) {
+    void updateWaitTimes(SimTime clock) {
+        for (auto process : processes) {
             // If process has never been on CPU, its wait time correponds to its arrival time
-            if (process->getLastTimeAssignedCpu() == -1)
-                process->setWaitTime(clock - process->getArrivalTime());
+            if (table->getLastTimeAssignedCpu(process) == -1)
+                table->setWaitTime(process, clock - table->getArrivalTime(process));
             // Otherwise its wait time corresponds to the last time it was assigned the CPU
             else
-                process->setWaitTime(clock - process->getLastTimeAssignedCpu());
+                table->setWaitTime(process, clock - table->getLastTimeAssignedCpu(process));
         }
     }
 
@@ -64,7 +93,7 @@ public:
      * Resorts the ReadyQueue. Intended to be used after updating priority values of processes in the ReadyQueue.
      */
     void sort() {
-        processes = set<Process*, PriorityComparator>(processes.begin(), processes.end());
+        processes = set<ProcessId, Ordering>(processes.begin(), processes.end(), Ordering(table));
     }
 
     /**
@@ -84,7 +113,10 @@ public:
     }
 
 private:
-    set<Process*, PriorityComparator> processes;
+    typedef typename PriorityComparator::template Ordering<Processes> Ordering;
+
+    Processes* table;
+    set<ProcessId, Ordering> processes;
 
 };
 
@@ -0,0 +1,281 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_REPLICATIONS_H
+#define CS4328_PROJECT1_REPLICATIONS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "RandomStream.h"
+#include "Statistics.h"
+#include "StreamingStatistics.h"
+
+using std::vector;
+
+/**
+ * How many independent replications of a simulation to run. With a target precision, replications are added one at a
+ * time (sequential stopping) until the confidence interval of the average turnaround time is narrow enough.
+ */
+struct ReplicationConfig {
+    // The fewest and the most replications to run
+    unsigned minReplications = 1;
+    unsigned maxReplications = 100;
+    // The target half-width of the average turnaround time's confidence interval, relative to the average (<= 0 to run
+    // exactly the fewest replications)
+    double precision = 0;
+    // The confidence level of the intervals
+    double confidence = 0.95;
+
+    /**
+     * Determines whether more than a single run was asked for.
+     * @return True if simulations should be replicated, false otherwise.
+     */
+    bool enabled() const { return minReplications > 1 || precision > 0; }
+};
+
+/**
+ * Calculates a quantile of the standard normal distribution, by Newton's method on the complementary error function.
+ * @param p The probability, between 0 and 1 (exclusive).
+ * @return The value the standard normal distribution is below with probability p.
+ */
+inline double normalQuantile(double p) {
+    double z = 0;
+    for (int i = 0; i < 50; i++) {
+        double error = 0.5 * std::erfc(-z / std::sqrt(2.0)) - p;
+        double density = std::exp(-z * z / 2) / std::sqrt(2 * M_PI);
+        double step = error / density;
+        z -= step;
+        if (std::fabs(step) < 1e-12)
+            break;
+    }
+    return z;
+}
+
+/**
+ * Calculates a quantile of Student's t distribution: exactly for 1 and 2 degrees of freedom, and with the
+ * Cornish-Fisher expansion around the normal quantile otherwise (within 1% for 3 or more degrees of freedom at
+ * confidence levels up to 99%).
+ * @param p The probability, between 0 and 1 (exclusive).
+ * @param degreesOfFreedom The degrees of freedom (at least 1).
+ * @return The value the t distribution is below with probability p.
+ */
+inline double studentTQuantile(double p, unsigned degreesOfFreedom) {
+    if (degreesOfFreedom == 1)
+        return std::tan(M_PI * (p - 0.5));
+    if (degreesOfFreedom == 2)
+        return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+
+    double z = normalQuantile(p), v = degreesOfFreedom;
+    double z2 = z * z, z3 = z2 * z, z5 = z3 * z2, z7 = z5 * z2, z9 = z7 * z2;
+    return z + (z3 + z) / (4 * v)
+           + (5 * z5 + 16 * z3 + 3 * z) / (96 * v * v)
+           + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * v * v * v)
+           + (79 * z9 + 776 * z7 + 1482 * z5 - 1920 * z3 - 945 * z) / (92160 * v * v * v * v);
+}
+
+/**
+ * The statistics of a simulation averaged over independent replications, with a confidence interval for every scalar
+ * statistic.
+ */
+struct ReplicatedStatistics {
+    // Every statistic averaged over the replications (the profile is merged instead)
+    Statistics mean;
+    // The half-width of the confidence interval of every scalar statistic
+    Statistics halfWidth;
+    unsigned replications;
+    double confidence;
+    // Whether the target precision was reached (always true without one)
+    bool converged;
+
+    /**
+     * Prints every scalar statistic with its confidence interval, followed by the per-core statistics and the profile
+     * as in Statistics::display().
+     */
+    void display() {
+        printf("        Replications : %6u  (%g%% confidence%s)\n", replications, confidence * 100,
+               converged ? "" : ", target precision not reached");
+        vector<double> halfWidths;
+        halfWidth.forEachScalar([&](const char*, double& h) { halfWidths.push_back(h); });
+        size_t i = 0;
+        mean.forEachScalar([&](const char* name, double& m) {
+            printf("%20s : %6.3f +/- %.3f\n", name, m, halfWidths[i++]);
+        });
+        if (mean.coreUtilization.size() > 1) {
+            printf("               Cores : %6zu\n"
+                   "   Core Util Min/Max : %6.3f / %.3f\n"
+                   "          Migrations : %6lu\n",
+                   mean.coreUtilization.size(),
+                   *std::min_element(mean.coreUtilization.begin(), mean.coreUtilization.end()),
+                   *std::max_element(mean.coreUtilization.begin(), mean.coreUtilization.end()),
+                   mean.migrations
+            );
+        }
+        if (INSTRUMENTED)
+            mean.profile.display();
+    }
+};
+
+/**
+ * The statistics of a number of replications, added one at a time, from which the mean and confidence interval of
+ * every statistic are calculated.
+ */
+class ReplicationSample {
+
+public:
+
+    /**
+     * Creates an empty ReplicationSample.
+     */
+    ReplicationSample() {
+        this->replications = 0;
+    }
+
+    /**
+     * Adds the statistics of a replication.
+     * @param s The statistics of the replication.
+     */
+    void add(Statistics s) {
+        size_t i = 0;
+        s.forEachScalar([&](const char*, double& x) {
+            if (i == scalars.size())
+                scalars.emplace_back();
+            scalars[i++].add(x);
+        });
+        coreUtilizations.resize(std::max(coreUtilizations.size(), s.coreUtilization.size()));
+        for (size_t c = 0; c < s.coreUtilization.size(); c++)
+            coreUtilizations[c].add(s.coreUtilization[c]);
+        migrations.add((double) s.migrations);
+        if (replications == 0)
+            profile = s.profile;
+        else
+            profile.merge(s.profile);
+        replications++;
+    }
+
+    /**
+     * Returns the number of replications added.
+     * @return The number of replications.
+     */
+    unsigned size() const { return replications; }
+
+    /**
+     * Calculates the half-width of the confidence interval of the average turnaround time (the first scalar).
+     * @param confidence The confidence level of the interval.
+     * @return The half-width, or 0 with fewer than two replications.
+     */
+    double turnaroundHalfWidth(double confidence) const {
+        return halfWidth(scalars[0], confidence);
+    }
+
+    /**
+     * Returns the mean of the average turnaround times.
+     * @return The mean average turnaround time.
+     */
+    double turnaroundMean() const { return scalars[0].getMean(); }
+
+    /**
+     * Calculates the mean and confidence interval of every statistic.
+     * @param confidence The confidence level of the intervals.
+     * @return The statistics averaged over the replications (assumed converged).
+     */
+    ReplicatedStatistics summarize(double confidence) const {
+        ReplicatedStatistics result {};
+        result.replications = replications;
+        result.confidence = confidence;
+        result.converged = true;
+        result.mean.profile = profile;
+
+        size_t i = 0;
+        result.mean.forEachScalar([&](const char*, double& m) { m = scalars[i++].getMean(); });
+        i = 0;
+        result.halfWidth.forEachScalar([&](const char*, double& h) { h = halfWidth(scalars[i++], confidence); });
+        for (auto& c : coreUtilizations)
+            result.mean.coreUtilization.push_back(c.getMean());
+        result.mean.migrations = (unsigned long) std::lround(migrations.getMean());
+        return result;
+    }
+
+private:
+    unsigned replications;
+    vector<RunningStatistics> scalars, coreUtilizations;
+    RunningStatistics migrations;
+    EventProfile profile;
+
+    /**
+     * Calculates the half-width of the confidence interval of the mean of one statistic.
+     * @param statistic The statistic over the replications.
+     * @param confidence The confidence level of the interval.
+     * @return The half-width, or 0 with fewer than two replications.
+     */
+    double halfWidth(const RunningStatistics& statistic, double confidence) const {
+        if (replications < 2)
+            return 0;
+        double t = studentTQuantile(1 - (1 - confidence) / 2, replications - 1);
+        return t * statistic.getStdDev() / std::sqrt(replications);
+    }
+
+};
+
+/**
+ * Subtracts one run's scalar statistics from another's, as for the paired differences of two schedulers simulated on
+ * the same processes.
+ * @param a The statistics to subtract from (its per-core statistics and profile are kept as they are).
+ * @param b The statistics to subtract.
+ * @return The scalar statistics of a minus those of b.
+ */
+inline Statistics scalarDifference(Statistics a, Statistics b) {
+    vector<double> subtrahends;
+    b.forEachScalar([&](const char*, double& x) { subtrahends.push_back(x); });
+    size_t i = 0;
+    a.forEachScalar([&](const char*, double& x) { x -= subtrahends[i++]; });
+    return a;
+}
+
+/**
+ * Runs independent replications of a simulation and calculates confidence intervals for its statistics. Each
+ * replication draws from its own random stream: the given stream numbered with the replication's number (see
+ * RandomStream::streamId()), so the first is the same as an unreplicated run. With a target precision, replications
+ * are added until the confidence interval of the average turnaround time is within the precision of the average, so
+ * light loads that converge quickly stop early while heavy loads get as many replications as they need.
+ * @tparam Replication A callable running one replication: Statistics(RandomStream& rng).
+ * @param config How many replications to run.
+ * @param seed The seed of the replications' random streams.
+ * @param stream The stream of the first replication (with replication number 0).
+ * @param replication Runs one replication.
+ * @return The averaged statistics and their confidence intervals.
+ */
+template <class Replication>
+ReplicatedStatistics replicate(const ReplicationConfig& config, unsigned long seed, unsigned long stream,
+                               Replication&& replication) {
+    // At least two replications are needed for a confidence interval, and a few more before stopping on one (the
+    // first few variance estimates are too unreliable to stop on)
+    unsigned minReplications = std::max(config.precision > 0 ? 5u : 2u, config.minReplications);
+    unsigned maxReplications = std::max(minReplications, config.maxReplications);
+
+    ReplicationSample sample;
+    bool converged = config.precision <= 0;
+    for (unsigned r = 0; r < maxReplications; r++) {
+        RandomStream rng(seed, stream + r);
+        sample.add(replication(rng));
+
+        // Stop once there are enough replications, and the average turnaround time is precise enough if asked
+        if (sample.size() < minReplications)
+            continue;
+        if (config.precision <= 0)
+            break;
+        if (sample.turnaroundHalfWidth(config.confidence) <= config.precision * std::fabs(sample.turnaroundMean())) {
+            converged = true;
+            break;
+        }
+    }
+
+    ReplicatedStatistics result = sample.summarize(config.confidence);
+    result.converged = converged;
+    return result;
+}
+
+#endif //CS4328_PROJECT1_REPLICATIONS_H
@@ -0,0 +1,286 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_RESULTCACHE_H
+#define CS4328_PROJECT1_RESULTCACHE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SimTime.h"
+#include "Statistics.h"
+
+using std::fstream;
+using std::runtime_error;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+/**
+ * The version of the simulator's results. Bump it whenever a change to the simulator changes the results it gives for
+ * the same parameters, so results cached by older versions are never used again.
+ */
+const uint32_t RESULT_VERSION = 1;
+
+/**
+ * Builds the key of a cached result by hashing, in order, every parameter the result depends on (64-bit FNV-1a,
+ * finished with a mixing step so nearby parameters get unrelated keys). The simulator's version and clock are always
+ * hashed first.
+ */
+class ResultKey {
+
+public:
+
+    /**
+     * Starts a key with the simulator's result version and clock resolution.
+     */
+    ResultKey() {
+        this->hash = 0xcbf29ce484222325ull;
+        add((uint64_t) RESULT_VERSION).add((uint64_t) TICK_CLOCK).add(TICKS_PER_SECOND);
+    }
+
+    /**
+     * Adds an integer parameter to the key.
+     * @param value The parameter.
+     * @return This key.
+     */
+    ResultKey& add(uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+        return *this;
+    }
+
+    /**
+     * Adds a real parameter to the key, by its exact bits.
+     * @param value The parameter.
+     * @return This key.
+     */
+    ResultKey& add(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return add(bits);
+    }
+
+    /**
+     * Returns the key of the parameters added so far.
+     * @return The key.
+     */
+    uint64_t get() const {
+        uint64_t z = hash;
+        z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31u);
+    }
+
+private:
+    uint64_t hash;
+
+};
+
+/**
+ * The number of scalar statistics (see Statistics::forEachScalar()).
+ */
+const int NUM_SCALAR_STATISTICS = 8 + 2 * NUM_STATISTICS_QUANTILES;
+
+/**
+ * The result of one simulation (or set of replications) as cached: its scalar statistics and the half-widths of their
+ * confidence intervals, and how long it took to simulate.
+ */
+struct CachedResult {
+    uint64_t key;
+    uint32_t replications;
+    uint32_t reserved;
+    double wallTime;
+    double statistics[NUM_SCALAR_STATISTICS];
+    double halfWidths[NUM_SCALAR_STATISTICS];
+
+    /**
+     * Copies the scalar statistics of a simulation into an array.
+     * @param s The statistics.
+     * @param values The array to copy them to, in the order of Statistics::forEachScalar().
+     */
+    static void storeScalars(Statistics s, double* values) {
+        int i = 0;
+        s.forEachScalar([&](const char*, double& x) { values[i++] = x; });
+    }
+
+    /**
+     * Makes statistics out of cached scalar statistics (with no per-core statistics or profile).
+     * @param values The scalar statistics, in the order of Statistics::forEachScalar().
+     * @return The statistics.
+     */
+    static Statistics loadScalars(const double* values) {
+        Statistics s {};
+        int i = 0;
+        s.forEachScalar([&](const char*, double& x) { x = values[i++]; });
+        return s;
+    }
+};
+
+/**
+ * The header at the start of a result cache file. It is followed directly by `count` CachedResults, in the order they
+ * were added. All values are stored in the machine's native byte order.
+ */
+struct ResultCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+};
+
+const char RESULT_CACHE_MAGIC[8] {'S', 'C', 'H', 'C', 'A', 'C', 'H', 'E'};
+const uint32_t RESULT_CACHE_VERSION = 1;
+
+/**
+ * A persistent, content-addressed cache of simulation results, keyed by a hash of everything a result depends on (see
+ * ResultKey). The cache file is memory-mapped and indexed once when opened, so looking results up reads them straight
+ * out of the mapping without parsing anything. New results are held in memory until save() appends them to the file,
+ * so the file only ever grows by whole records and a cache that's never saved is left as it was.
+ */
+class ResultCache {
+
+public:
+
+    /**
+     * Opens a result cache file, or starts an empty cache if the file doesn't exist yet.
+     * @param path The path of the cache file.
+     * @throws runtime_error If the file exists but can't be read or isn't a valid cache.
+     */
+    explicit ResultCache(const string& path) {
+        this->path = path;
+        this->mapping = nullptr;
+        this->length = 0;
+        this->count = 0;
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            if (errno == ENOENT) return;
+            throw runtime_error("Can't open cache \"" + path + "\": " + strerror(errno));
+        }
+        struct stat st {};
+        if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(ResultCacheHeader)) {
+            close(fd);
+            throw runtime_error("\"" + path + "\" is not a result cache");
+        }
+
+        this->length = (size_t) st.st_size;
+        void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED)
+            throw runtime_error("Can't map cache \"" + path + "\": " + strerror(errno));
+        this->mapping = static_cast<char*>(m);
+
+        const ResultCacheHeader* header = reinterpret_cast<const ResultCacheHeader*>(mapping);
+        if (memcmp(header->magic, RESULT_CACHE_MAGIC, sizeof(RESULT_CACHE_MAGIC)) != 0
+            || header->version != RESULT_CACHE_VERSION || header->recordSize != sizeof(CachedResult)
+            || header->count > (length - sizeof(ResultCacheHeader)) / sizeof(CachedResult)) {
+            munmap(mapping, length);
+            this->mapping = nullptr;
+            throw runtime_error("\"" + path + "\" is not a valid result cache");
+        }
+
+        // Index every record (a result added again later replaces the earlier one)
+        this->count = header->count;
+        const CachedResult* records = reinterpret_cast<const CachedResult*>(mapping + sizeof(ResultCacheHeader));
+        index.reserve(count);
+        for (size_t i = 0; i < count; i++)
+            index[records[i].key] = &records[i];
+    }
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    /**
+     * Unmaps the cache file. Results added since the last save() are lost.
+     */
+    ~ResultCache() {
+        if (mapping != nullptr)
+            munmap(mapping, length);
+    }
+
+    /**
+     * Looks up a result.
+     * @param key The key of the result.
+     * @return The cached result, or nullptr if there is none. It stays valid as long as the cache.
+     */
+    const CachedResult* find(uint64_t key) const {
+        auto it = index.find(key);
+        return it == index.end() ? nullptr : it->second;
+    }
+
+    /**
+     * Returns the number of results in the cache file (not counting any added since it was opened).
+     * @return The number of results.
+     */
+    size_t size() const { return index.size(); }
+
+    /**
+     * Adds a result, to be written to the cache file by save(). Not thread safe.
+     * @param result The result, with its key.
+     */
+    void add(const CachedResult& result) {
+        pending.push_back(result);
+    }
+
+    /**
+     * Appends the results added since the last save to the cache file, creating it if needed.
+     * @throws runtime_error If the file can't be written.
+     */
+    void save() {
+        if (pending.empty()) return;
+
+        ResultCacheHeader header {};
+        memcpy(header.magic, RESULT_CACHE_MAGIC, sizeof(RESULT_CACHE_MAGIC));
+        header.version = RESULT_CACHE_VERSION;
+        header.recordSize = sizeof(CachedResult);
+        header.count = count;
+
+        fstream out;
+        if (mapping != nullptr)
+            out.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        else
+            out.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw runtime_error("Can't write cache \"" + path + "\"");
+
+        // Write the new records right after the last counted one (overwriting anything left by an interrupted save),
+        // then count them in the header
+        out.seekp((std::streamoff) (sizeof(header) + count * sizeof(CachedResult)));
+        out.write(reinterpret_cast<const char*>(pending.data()),
+                  (std::streamsize) (pending.size() * sizeof(CachedResult)));
+        out.flush();
+        header.count += pending.size();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out)
+            throw runtime_error("Error writing cache \"" + path + "\"");
+        count = header.count;
+        pending.clear();
+    }
+
+private:
+    string path;
+    char* mapping;
+    size_t length;
+    // The number of records in the file
+    size_t count;
+    unordered_map<uint64_t, const CachedResult*> index;
+    vector<CachedResult> pending;
+
+};
+
+
+#endif //CS4328_PROJECT1_RESULTCACHE_H
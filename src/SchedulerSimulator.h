@@ -0,0 +1,167 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_SCHEDULERSIMULATOR_H
+#define CS4328_PROJECT1_SCHEDULERSIMULATOR_H
+
+#include <cmath>
+#include <stdexcept>
+#include "ClusterSimulation.h"
+#include "Replications.h"
+#include "Simulation.h"
+
+using std::runtime_error;
+
+// The shortest interval (in seconds) a periodic event may recur at: one tick of the tick clock. Any shorter, and the
+// clock could stop advancing.
+const double MIN_INTERVAL = 1e-9;
+
+/*
+ * The simulator as a library: a job describes one run of the simulator, as given on the command line for a single
+ * scheduler, and runJob() or replicateJob() runs it in the calling thread and returns its statistics. Jobs share
+ * nothing, so any number can run at once on different threads. The command line, the server mode (see JobServer.h)
+ * and the C interface (see schedsim.h) all run their simulations through these functions.
+ */
+
+/**
+ * Everything one run of the simulator needs.
+ */
+struct JobSpec {
+    // The scheduler, numbered as on the command line: (1) FCFS, (2) SRTF, (3) HRRN, (4) RR, (5) MLFQ, (6) CFS
+    int scheduler = 1;
+    SimulationConfig config;
+    EventQueueBackend backend = SET_QUEUE;
+    // The seed and stream of the random stream processes are generated from (for the first replication, if
+    // replicated)
+    unsigned long seed = 0;
+    unsigned long stream = 0;
+    // Whether to simulate a cluster model instead of a single system, and its parameters
+    bool clusterModel = false;
+    ClusterConfig cluster;
+    ReplicationConfig replication;
+};
+
+/**
+ * Checks that the options of a job can be used together and are within range (the scheduler is checked when the job
+ * is run).
+ * @param job The job.
+ * @throws runtime_error Saying what is wrong with the job, if anything is.
+ */
+inline void validateJob(const JobSpec& job) {
+    const SimulationConfig& config = job.config;
+    const ClusterConfig& cluster = job.cluster;
+    const ReplicationConfig& replication = job.replication;
+    bool replayTrace = !config.tracePath.empty();
+
+    if (cluster.dispatchDelay < 0 || (cluster.routing == LEAST_LOADED_ROUTING && cluster.dispatchDelay == 0))
+        throw runtime_error("Invalid dispatch delay. Must be at least 0, and more than 0 with least loaded routing");
+    if (job.clusterModel && config.deleteWarmup)
+        throw runtime_error("The warm-up can't be deleted from a cluster model");
+    if (!config.eventLogPath.empty() && (job.clusterModel || replication.enabled()))
+        throw runtime_error("An event log records a single simulation, so it can't be written for clusters or "
+                            "replications");
+    if (replayTrace && replication.enabled())
+        throw runtime_error("A trace replays the same processes every time, so it can't be replicated");
+    if ((!config.checkpointPath.empty() || !config.resumePath.empty()) && (job.clusterModel || replication.enabled()))
+        throw runtime_error("A checkpoint holds a single simulation, so it can't be saved or resumed for clusters or "
+                            "replications");
+    if (config.resetStatistics && config.resumePath.empty())
+        throw runtime_error("Statistics can only be reset when resuming a checkpoint");
+
+    // An infinite rate, time or interval would keep a simulation running forever
+    const pair<const char*, double> reals[] {
+            {"arrival rate", config.arrivalRate}, {"service time", config.serviceTime},
+            {"quantum length", config.quantumLength}, {"query interval", config.queryInterval},
+            {"boost interval", config.boostInterval}, {"target latency", config.targetLatency},
+            {"dispatch delay", cluster.dispatchDelay}, {"checkpoint time", config.checkpointTime},
+            {"precision", replication.precision}, {"confidence level", replication.confidence}};
+    for (const auto& real : reals)
+        if (!std::isfinite(real.second))
+            throw runtime_error(string("Invalid ") + real.first + ". Must be finite");
+    const pair<const char*, double> intervals[] {
+            {"quantum length", config.quantumLength}, {"query interval", config.queryInterval},
+            {"boost interval", config.boostInterval}, {"target latency", config.targetLatency},
+            {"dispatch delay", cluster.dispatchDelay}};
+    for (const auto& interval : intervals)
+        if (interval.second > 0 && interval.second < MIN_INTERVAL)
+            throw runtime_error(string("Invalid ") + interval.first + ". Must be at least 1 ns if more than 0");
+    for (double quantum : config.levelQuanta)
+        if (!std::isfinite(quantum) || quantum < MIN_INTERVAL)
+            throw runtime_error("Invalid level quanta. Each must be finite and at least 1 ns");
+
+    if (config.numProcesses < 1)
+        throw runtime_error("Invalid number of processes. Must be at least 1");
+    if (!replayTrace && !(config.arrivalRate > 0 && config.serviceTime > 0))
+        throw runtime_error("Invalid arrival rate or service time. Both must be more than 0");
+    if (config.numCores < 1 || config.numCores > 65535)
+        throw runtime_error("Invalid number of cores. Must be between 1 and 65535");
+    if (cluster.numClusters < 1 || cluster.numClusters > 65535)
+        throw runtime_error("Invalid number of clusters. Must be between 1 and 65535");
+    if (config.feedbackLevels < 1 || config.feedbackLevels > 64)
+        throw runtime_error("Invalid number of levels. Must be between 1 and 64");
+    if (replication.minReplications < 1)
+        throw runtime_error("Invalid number of replications. Must be at least 1");
+    if (!(replication.confidence > 0 && replication.confidence < 1))
+        throw runtime_error("Invalid confidence level. Must be between 0 and 1 (exclusive)");
+}
+
+/**
+ * Checks the scheduler of a job.
+ * @param job The job.
+ * @throws runtime_error If the scheduler isn't one of the available schedulers.
+ */
+inline void checkScheduler(const JobSpec& job) {
+    if (job.scheduler < 1 || job.scheduler > 6)
+        throw runtime_error("Invalid scheduler " + std::to_string(job.scheduler) + ". Must be between 1 and 6");
+}
+
+/**
+ * Simulates a job once, from its random stream (or trace).
+ * @param job The job, which must be valid (see validateJob()).
+ * @return The statistics of the simulation.
+ * @throws runtime_error If the scheduler is invalid, or a file the job reads or writes can't be.
+ */
+inline Statistics runJob(const JobSpec& job) {
+    checkScheduler(job);
+    RandomStream rng(job.seed, job.stream);
+    if (job.clusterModel)
+        return simulateClusters(job.backend, job.scheduler, job.config, job.cluster, rng);
+    return simulate(job.backend, job.scheduler, job.config, rng);
+}
+
+/**
+ * Simulates a job's replications (see replicate()), the first of which is the same as runJob().
+ * @param job The job, which must be valid (see validateJob()).
+ * @return The statistics averaged over the replications, and their confidence intervals.
+ * @throws runtime_error If the scheduler is invalid, or a file the job reads can't be.
+ */
+inline ReplicatedStatistics replicateJob(const JobSpec& job) {
+    checkScheduler(job);
+    return replicate(job.replication, job.seed, job.stream, [&](RandomStream& rng) {
+        if (job.clusterModel)
+            return simulateClusters(job.backend, job.scheduler, job.config, job.cluster, rng);
+        return simulate(job.backend, job.scheduler, job.config, rng);
+    });
+}
+
+/**
+ * Simulates a job, replicated if it asks for replications (see replicateJob()) and once otherwise (see runJob()).
+ * @param job The job, which must be valid (see validateJob()).
+ * @return The statistics, as a single replication with half-widths of 0 if the job wasn't replicated.
+ * @throws runtime_error If the scheduler is invalid, or a file the job reads or writes can't be.
+ */
+inline ReplicatedStatistics simulateJob(const JobSpec& job) {
+    if (job.replication.enabled())
+        return replicateJob(job);
+    ReplicatedStatistics r {};
+    r.mean = runJob(job);
+    r.replications = 1;
+    r.confidence = job.replication.confidence;
+    r.converged = true;
+    return r;
+}
+
+
+#endif //CS4328_PROJECT1_SCHEDULERSIMULATOR_H
@@ -0,0 +1,88 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_SCHEDULINGPOLICY_H
+#define CS4328_PROJECT1_SCHEDULINGPOLICY_H
+
+#include "PriorityComparator.h"
+#include "ReadyQueue.h"
+#include "HRRNReadyQueue.h"
+#include "MLFQReadyQueue.h"
+
+/**
+ * How a scheduler takes the CPU away from a process that hasn't finished (other than by preemption on arrival).
+ */
+enum TimeSlicing {
+    // Never, the process runs until it departs
+    NO_TIME_SLICING,
+    // At every quantum boundary, which falls every quantum from time 0 (round robin)
+    FIXED_QUANTUM,
+    // At the end of the quantum of the process' priority level, after which it drops a level (MLFQ)
+    FEEDBACK_QUANTUM,
+    // At the end of its share of the target latency, which is charged to its virtual runtime (CFS)
+    FAIR_SLICE
+};
+
+/**
+ * Describes a scheduler at compile time, so the simulation can be specialized for it: branches for behavior the
+ * scheduler doesn't have (and the events they would schedule) are compiled out entirely.
+ * @tparam Comparator The comparator that determines process priority.
+ * @tparam Preemptive Whether an arriving process with higher priority preempts the process on the CPU.
+ * @tparam Slicing How the process on the CPU is switched out when its time is up.
+ * @tparam DynamicPriority Whether priorities change as processes wait, so the ready queue must be updated over time.
+ * @tparam Queue The ready queue implementation to use, instantiated with the comparator and the process table type.
+ */
+template <PRIORITY_COMPARATOR Comparator, bool Preemptive, TimeSlicing Slicing, bool DynamicPriority,
+          template <class, class> class Queue = ReadyQueue>
+struct SchedulingPolicy {
+    static_assert(IsPriorityComparator<Comparator>::value,
+                  "Comparator must have a static bool compare(processes, ProcessId, ProcessId)");
+
+    typedef Comparator ComparatorType;
+    template <class Processes>
+    using ReadyQueueType = Queue<Comparator, Processes>;
+
+    static constexpr bool preemptive = Preemptive;
+    static constexpr TimeSlicing slicing = Slicing;
+    static constexpr bool timeSliced = Slicing != NO_TIME_SLICING;
+    static constexpr bool dynamicPriority = DynamicPriority;
+};
+
+/**
+ * First Come First Serve (FCFS): non-preemptive, processes run in order of arrival.
+ */
+typedef SchedulingPolicy<FCFSPriorityComparator, false, NO_TIME_SLICING, false> FCFSPolicy;
+
+/**
+ * Shortest Remaining Time First (SRTF): an arriving process preempts the running one if it has less time left.
+ */
+typedef SchedulingPolicy<SRTFPriorityComparator, true, NO_TIME_SLICING, false> SRTFPolicy;
+
+/**
+ * Highest Response Ratio Next (HRRN): non-preemptive, with priorities that grow as processes wait.
+ */
+typedef SchedulingPolicy<HRRNPriorityComparator, false, NO_TIME_SLICING, true, HRRNReadyQueue> HRRNPolicy;
+
+/**
+ * Round Robin (RR): processes are switched out at the end of every quantum.
+ */
+typedef SchedulingPolicy<FCFSPriorityComparator, false, FIXED_QUANTUM, false> RRPolicy;
+
+/**
+ * Multi-level feedback queue (MLFQ): processes start on the highest priority level, drop a level every time they use up
+ * their level's quantum, and are all boosted back to the top periodically. An arriving process preempts one running on
+ * a lower level.
+ */
+typedef SchedulingPolicy<MLFQPriorityComparator, true, FEEDBACK_QUANTUM, false, MLFQReadyQueue> MLFQPolicy;
+
+/**
+ * Completely Fair Scheduler (CFS): the process with the least virtual runtime runs next, for its share of the target
+ * latency. The ready queue is a red-black tree (std::set) ordered by virtual runtime, so picking the next process takes
+ * O(log n) time.
+ */
+typedef SchedulingPolicy<CFSPriorityComparator, false, FAIR_SLICE, false> CFSPolicy;
+
+
+#endif //CS4328_PROJECT1_SCHEDULINGPOLICY_H
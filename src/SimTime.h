@@ -0,0 +1,107 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_SIMTIME_H
+#define CS4328_PROJECT1_SIMTIME_H
+
+#include <cmath>
+#include <cstdint>
+
+/*
+ * The representation of simulated time. By default times are doubles in seconds. Building with SCHEDSIM_TICK_CLOCK
+ * defined makes them 64-bit integer ticks instead, SCHEDSIM_TICKS_PER_SECOND to the second (a billion, i.e. 1 ns ticks,
+ * unless defined otherwise): events are then ordered by exact integer compares, durations add up without rounding
+ * error however long the run, and the calendar queue finds an event's day with an integer division. Times from the
+ * workload are rounded to the nearest tick as processes arrive, and statistics are converted back to seconds as they
+ * are gathered, so everything outside the simulation core stays in seconds.
+ */
+#ifdef SCHEDSIM_TICK_CLOCK
+#ifndef SCHEDSIM_TICKS_PER_SECOND
+#define SCHEDSIM_TICKS_PER_SECOND 1000000000
+#endif
+typedef int64_t SimTime;
+constexpr bool TICK_CLOCK = true;
+constexpr double TICKS_PER_SECOND = SCHEDSIM_TICKS_PER_SECOND;
+// A time later than any event
+constexpr SimTime NEVER = INT64_MAX;
+#else
+typedef double SimTime;
+constexpr bool TICK_CLOCK = false;
+constexpr double TICKS_PER_SECOND = 1;
+constexpr SimTime NEVER = INFINITY;
+#endif
+
+/**
+ * Converts a number of ticks, possibly fractional, to a time: rounded to the nearest tick with the tick clock, or
+ * unchanged otherwise.
+ * @param ticks The number of ticks.
+ * @return The time.
+ */
+inline SimTime roundTicks(double ticks) {
+    if constexpr (TICK_CLOCK)
+        return (SimTime) std::llround(ticks);
+    else
+        return ticks;
+}
+
+/**
+ * Converts seconds to a time (or a duration).
+ * @param seconds The time (in seconds).
+ * @return The time in the clock's representation.
+ */
+inline SimTime toSimTime(double seconds) {
+    if constexpr (TICK_CLOCK)
+        return roundTicks(seconds * TICKS_PER_SECOND);
+    else
+        return seconds;
+}
+
+/**
+ * Converts a service time to a duration, which with the tick clock is at least one tick (so no process needs no
+ * service, which would make its response ratio undefined).
+ * @param seconds The service time (in seconds).
+ * @return The service time in the clock's representation.
+ */
+inline SimTime toServiceTime(double seconds) {
+    if constexpr (TICK_CLOCK) {
+        SimTime ticks = toSimTime(seconds);
+        return ticks > 0 ? ticks : 1;
+    } else {
+        return seconds;
+    }
+}
+
+/**
+ * Converts a time (or a duration) to seconds.
+ * @param time The time in the clock's representation.
+ * @return The time (in seconds).
+ */
+inline double toSeconds(SimTime time) {
+    if constexpr (TICK_CLOCK)
+        return (double) time / TICKS_PER_SECOND;
+    else
+        return time;
+}
+
+/**
+ * Converts a process' waiting time, its turnaround time less its service time, to seconds. With the tick clock the
+ * difference is exact, but with the double clock the turnaround time is a difference of times rounded to the clock's
+ * precision, so a process that never waited comes out a few rounding errors of the clock away from 0. A waiting time
+ * within that (2^-40 of the clock, under a microsecond for runs shorter than ten days) is taken to be 0.
+ * @param turnaround The process' turnaround time.
+ * @param service The process' service time.
+ * @param clock The time the process departed.
+ * @return The waiting time (in seconds), at least 0.
+ */
+inline double toWaitingSeconds(SimTime turnaround, SimTime service, SimTime clock) {
+    SimTime waiting = turnaround - service;
+    if constexpr (!TICK_CLOCK)
+        if (waiting <= std::ldexp(clock, -40))
+            return 0;
+    return toSeconds(waiting);
+}
+
+
+#endif //CS4328_PROJECT1_SIMTIME_H
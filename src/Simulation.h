@@ -0,0 +1,1314 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_SIMULATION_H
+#define CS4328_PROJECT1_SIMULATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "EventQueue.h"
+#include "HeapEventQueue.h"
+#include "CalendarEventQueue.h"
+#include "EventLog.h"
+#include "SchedulingPolicy.h"
+#include "RandomStream.h"
+#include "Workload.h"
+#include "ProcessPool.h"
+#include "ProcessTable.h"
+#include "StreamingStatistics.h"
+#include "Statistics.h"
+#include "Instrumentation.h"
+#include "Checkpoint.h"
+
+using std::pair;
+using std::set;
+using std::unique_ptr;
+using std::unordered_map;
+using std::string;
+using std::vector;
+
+/**
+ * The parameters of a single simulation.
+ */
+struct SimulationConfig {
+    // The number of processes to simulate (higher = more accurate statistics)
+    int numProcesses = 10000;
+    // The average arrival rate (in processes/second) and average service time (in seconds) of the processes
+    double arrivalRate = 1;
+    double serviceTime = 0.06;
+    // A binary trace file to replay processes from instead of generating them (empty to generate them)
+    string tracePath;
+    // A binary event log to write every arrival, dispatch, preemption and departure to (empty for none)
+    string eventLogPath;
+    // The quantum length (in seconds), only used by time sliced schedulers
+    double quantumLength = 0;
+    // The interval at which the ready queue size is sampled (<= 0 to integrate statistics exactly at every event)
+    double queryInterval = 0.01;
+    // Whether cancelled departures are tombstoned in the event queue rather than removed right away
+    bool lazyCancellation = false;
+    // The number of CPU cores, and whether each core has its own ready queue (with work stealing) instead of all the
+    // cores sharing one
+    unsigned numCores = 1;
+    bool perCoreQueues = false;
+    // MLFQ only: the quantum length (in seconds, at least 1 ns) of each priority level from the highest down, or if
+    // empty, the number of levels, whose quanta double from the quantum length (<= 0 to run processes until they
+    // depart) down the levels. Every process is boosted back to the highest level every boost interval (in seconds,
+    // <= 0 never)
+    vector<double> levelQuanta;
+    unsigned feedbackLevels = 3;
+    double boostInterval = 1;
+    // Whether to detect the end of the warm-up (with MSER-5 on the turnaround times) and delete it from the statistics,
+    // then simulate the number of processes above on top of it (not for the clusters of a ClusterSimulation)
+    bool deleteWarmup = false;
+    // CFS only: the target latency (in seconds), the time in which every runnable process should get a slice (<= 0
+    // for 8 quantum lengths). The quantum length is the shortest slice a process gets
+    double targetLatency = 0;
+    // A checkpoint file to save the whole state of the simulation to (empty for none): once the run is over, or if the
+    // checkpoint time (in seconds) is >= 0, before handling the first event at or after it
+    string checkpointPath;
+    double checkpointTime = -1;
+    // A checkpoint file to resume the simulation from instead of starting it empty (empty for none), and whether to
+    // forget the statistics gathered before the checkpoint, as if they were a deleted warm-up (then the number of
+    // processes above is simulated on top of them)
+    string resumePath;
+    bool resetStatistics = false;
+};
+
+/**
+ * The process table simulations use unless told otherwise: the structure of arrays ProcessTable, or the array of
+ * Process objects ProcessPool when built with SCHEDSIM_AOS_PROCESSES defined.
+ */
+#ifdef SCHEDSIM_AOS_PROCESSES
+typedef ProcessPool DefaultProcessTable;
+#else
+typedef ProcessTable DefaultProcessTable;
+#endif
+
+/**
+ * Simulates a priority based scheduling algorithm on one or more CPU cores, specialized at compile time for a
+ * scheduling policy and an event queue implementation.
+ *
+ * The cores either share a single ready queue, or each has its own. With per-core ready queues, an arriving process
+ * joins the shortest queue, and a core whose queue runs dry steals the front process of the longest queue (a
+ * migration). Either way an arriving process goes to an idle core if there is one, and a core only goes idle once
+ * every ready queue is empty, so no process waits while a core is idle. Idle cores are kept on a stack and queue
+ * lengths in an ordered set, so every event costs O(log cores) at most, never a scan of the cores.
+ *
+ * With one core this is exactly the classic single CPU simulation.
+ * @tparam Policy The SchedulingPolicy describing the scheduler.
+ * @tparam EventQueueType The event queue implementation to use (EventQueue, HeapEventQueue or CalendarEventQueue).
+ * @tparam Workload The source of the processes (SyntheticWorkload or TraceWorkload).
+ * @tparam Processes The table the processes are stored in (ProcessTable or ProcessPool).
+ */
+template <class Policy, class EventQueueType = EventQueue, class Workload = SyntheticWorkload,
+          class Processes = DefaultProcessTable>
+class Simulation {
+
+public:
+
+    /**
+     * Sets up a simulation, scheduling the first process' arrival, or resuming the configured checkpoint.
+     * @param config The parameters of the simulation.
+     * @param workload The source of the processes to simulate.
+     * @throws runtime_error If the event log can't be created, or the checkpoint can't be resumed.
+     */
+    Simulation(const SimulationConfig& config, Workload& workload)
+            : config(config), eventQueue(config.lazyCancellation),
+              readyQueues(config.perCoreQueues ? config.numCores : 1, ReadyQueueType(processes)),
+              workload(workload),
+              cores(config.numCores, Core {NO_PROCESS, NO_EVENT, toSimTime(config.quantumLength), 0, 0, 0}) {
+        this->clock = 0;
+        this->quantumLength = toSimTime(config.quantumLength);
+        this->queryInterval = toSimTime(config.queryInterval);
+        this->boostInterval = toSimTime(config.boostInterval);
+        this->busyCores = 0;
+        this->waitingProcesses = 0;
+        this->exactStatistics = queryInterval <= 0;
+
+        this->processesSimulated = 0;
+        this->processesCreated = 0;
+        this->totalInReadyQueue = 0;
+        this->migrations = 0;
+        this->departureLog = nullptr;
+        this->eventsHandled = 0;
+        this->warmingUp = config.deleteWarmup;
+        this->warmupProcesses = 0;
+        this->warmupTime = 0;
+        if constexpr (INSTRUMENTED)
+            profile.start();
+        if (!config.eventLogPath.empty())
+            eventLog.reset(new EventLog(config.eventLogPath));
+
+        this->nextBoost = boostInterval > 0 ? boostInterval : NEVER;
+        this->targetLatency = config.targetLatency > 0 ? toSimTime(config.targetLatency) : 8 * quantumLength;
+        if constexpr (Policy::slicing == FEEDBACK_QUANTUM) {
+            for (double quantum : config.levelQuanta)
+                levelQuanta.push_back(toSimTime(quantum));
+            if (levelQuanta.empty())
+                for (unsigned level = 0; level < std::max(1u, config.feedbackLevels); level++)
+                    levelQuanta.push_back(toSimTime(ldexp(config.quantumLength, (int) level)));
+        }
+        if constexpr (Policy::slicing == FAIR_SLICE)
+            virtualClocks.assign(readyQueues.size(), 0);
+
+        // Every core starts idle, with core 0 on top of the stack
+        for (unsigned c = config.numCores; c-- > 0;)
+            idleCores.push_back(c);
+        if (config.perCoreQueues)
+            for (unsigned c = 0; c < config.numCores; c++)
+                queueLengths.insert({0, c});
+
+        if (!config.resumePath.empty()) {
+            restore(config.resumePath);
+            return;
+        }
+
+        // Schedule first process arrival (at time 0, whatever its inter-arrival time)
+        double interArrivalTime, serviceTime;
+        if (workload.next(interArrivalTime, serviceTime)) {
+            eventQueue.scheduleEvent(clock, ARRIVAL, processes.acquire(0, 0, toServiceTime(serviceTime)));
+            processesCreated++;
+        }
+
+        // Schedule first query event (unless integrating statistics exactly)
+        if (!exactStatistics)
+            eventQueue.scheduleEvent(clock + queryInterval, QUERY);
+    }
+
+    /**
+     * Runs the simulation until the configured number of processes have departed, or every process of the workload
+     * has.
+     * @return A Statistics struct containing the average turnaround time of all processes simulated (in seconds),
+     *         the throughput of the simulation (in processes/second), the average CPU utilization, the average ready
+     *         queue size, the spread and percentiles of the turnaround and waiting times, and the utilization of each
+     *         core.
+     * @throws runtime_error If the event log or the checkpoint can't be written.
+     */
+    Statistics run() {
+        bool checkpointAtTime = !config.checkpointPath.empty() && config.checkpointTime >= 0;
+        if (checkpointAtTime) {
+            SimTime checkpointTime = toSimTime(config.checkpointTime);
+            while (unfinished() && eventQueue.nextTime() < checkpointTime)
+                step();
+            saveCheckpoint(config.checkpointPath);
+        }
+        while (unfinished())
+            step();
+        if (!config.checkpointPath.empty() && !checkpointAtTime)
+            saveCheckpoint(config.checkpointPath);
+        if (eventLog)
+            eventLog->close();
+
+        StatisticsAccumulator totals;
+        collectStatistics(totals, clock);
+        Statistics s = totals.finish(readyQueueSize.getStartTime(), toSeconds(clock), config.queryInterval);
+        s.warmupProcesses = warmupProcesses;
+        s.warmupTime = toSeconds(warmupTime);
+        return s;
+    }
+
+    /*
+     * The methods below let the simulation run as one logical process of a larger model (see ClusterSimulation), with
+     * processes arriving from outside and time advanced a window at a time.
+     */
+
+    /**
+     * Handles every event before a time.
+     * @param endTime The time (in seconds) to simulate up to (exclusive).
+     */
+    void runUntil(SimTime endTime) {
+        while (!eventQueue.empty() && eventQueue.nextTime() < endTime)
+            step();
+    }
+
+    /**
+     * Handles events until every process that has arrived or been scheduled to arrive has departed.
+     */
+    void drain() {
+        while (processesSimulated < processesCreated && !eventQueue.empty())
+            step();
+    }
+
+    /**
+     * Returns the time of the next event.
+     * @return The time (in seconds) of the next event, or NEVER if there is none.
+     */
+    SimTime nextEventTime() {
+        return eventQueue.empty() ? NEVER : eventQueue.nextTime();
+    }
+
+    /**
+     * Schedules the arrival of a process from outside the simulation.
+     * @param time The arrival time (in seconds) of the process, no earlier than the current time.
+     * @param id The ID of the process.
+     * @param serviceTime The service time (in seconds) of the process.
+     */
+    void injectArrival(SimTime time, int id, SimTime serviceTime) {
+        eventQueue.scheduleEvent(time, ARRIVAL, processes.acquire(id, time, serviceTime));
+        processesCreated++;
+    }
+
+    /**
+     * Records the time of every departure from now on in a log.
+     * @param log The log to append departure times to (nullptr to stop logging).
+     */
+    void setDepartureLog(vector<SimTime>* log) {
+        departureLog = log;
+    }
+
+    /**
+     * Handles the next event, which there must be.
+     */
+    void handleNextEvent() {
+        step();
+    }
+
+    /**
+     * Returns the number of processes that have departed.
+     * @return The number of processes simulated.
+     */
+    int getProcessesSimulated() const { return this->processesSimulated; }
+
+    /**
+     * Returns the number of processes that have arrived or been scheduled to arrive but not departed yet.
+     * @return The number of processes in the system.
+     */
+    int getProcessesInSystem() const { return this->processesCreated - this->processesSimulated; }
+
+    /**
+     * Returns the current simulation time.
+     * @return The time (in seconds) of the last event handled.
+     */
+    SimTime getTime() const { return this->clock; }
+
+    /**
+     * Returns the number of events handled so far.
+     * @return The number of events handled.
+     */
+    unsigned long getEventsHandled() const { return this->eventsHandled; }
+
+    /**
+     * Adds the totals behind the simulation's statistics to an accumulator.
+     * @param totals The accumulator to add the totals to.
+     * @param endTime The time (in seconds) to accumulate up to, no earlier than the last departure.
+     */
+    void collectStatistics(StatisticsAccumulator& totals, SimTime endTime) {
+        StatisticsAccumulator own;
+        own.numSimulations = 1;
+        own.exactStatistics = exactStatistics;
+        own.processesSimulated = processesSimulated;
+        own.turnaroundTimes = turnaroundTimes;
+        own.waitingTimes = waitingTimes;
+        own.turnaroundHistogram = turnaroundHistogram;
+        own.waitingHistogram = waitingHistogram;
+
+        // Each core's idle time, counting the time idle cores have been idle up to the end
+        for (auto& c : cores)
+            own.coreIdleTimes.push_back(toSeconds(c.idleTime + (c.onCpu == NO_PROCESS ? endTime - c.lastBusyTime : 0)));
+        own.migrations = migrations;
+
+        own.readyQueueIntegral = readyQueueSize.getIntegral(toSeconds(endTime));
+        own.cpuBusyIntegral = cpuBusy.getIntegral(toSeconds(endTime));
+        own.totalInReadyQueue = totalInReadyQueue;
+        if constexpr (INSTRUMENTED) {
+            own.profile = profile;
+            own.profile.stop();
+        }
+        totals.merge(own);
+    }
+
+private:
+    typedef typename Policy::ComparatorType Comparator;
+    typedef typename Policy::template ReadyQueueType<Processes> ReadyQueueType;
+
+    // Whether each process gets its own slice when it is assigned a core (MLFQ and CFS), rather than running until the
+    // next quantum boundary (round robin)
+    static constexpr bool slicedPerProcess = Policy::slicing == FEEDBACK_QUANTUM || Policy::slicing == FAIR_SLICE;
+
+    // Tells the schedulers apart in a checkpoint, since each one's state only makes sense to itself
+    static constexpr uint32_t POLICY_FINGERPRINT =
+            (uint32_t) Policy::slicing << 2u | (uint32_t) Policy::preemptive << 1u | (uint32_t) Policy::dynamicPriority;
+
+    /**
+     * The state of one CPU core.
+     */
+    struct Core {
+        // The process currently using the core (NO_PROCESS if idle)
+        ProcessId onCpu;
+        // Pending timeout (only while the core is busy, or with a slice per process, while the process on the core
+        // would outlast its slice) and the time of the core's next quantum boundary
+        EventHandle timeout;
+        SimTime nextTimeout;
+        // With preemption, the rank of the core among the busy ones (the higher, the sooner it is preempted): the
+        // tentative departure time of the process using it, or its priority level with MLFQ
+        SimTime rank;
+        // Last time the core went idle, and the total time it has been idle
+        SimTime lastBusyTime;
+        SimTime idleTime;
+    };
+
+    SimulationConfig config;
+
+    // Data structures to hold events and processes (one ready queue, or one per core, holding IDs in the process
+    // table, which must come first)
+    Processes processes;
+    EventQueueType eventQueue;
+    vector<ReadyQueueType> readyQueues;
+
+    // Source of the inter-arrival and service times of the processes
+    Workload& workload;
+
+    vector<Core> cores;
+    // Stack of idle cores, and the number of busy ones
+    vector<unsigned> idleCores;
+    unsigned busyCores;
+    // With per-core ready queues: (length, core) of every core's ready queue
+    set<pair<unsigned long, unsigned>> queueLengths;
+    // With a shared ready queue and preemption: (rank, core) of every busy core
+    set<pair<SimTime, unsigned>> running;
+
+    SimTime clock;
+    // The quantum length, query interval and boost interval of the configuration, in the clock's representation
+    SimTime quantumLength;
+    SimTime queryInterval;
+    SimTime boostInterval;
+    // The number of processes in all the ready queues
+    unsigned long waitingProcesses;
+
+    // Variables to hold statistics about simulation
+    bool exactStatistics;
+    int processesSimulated;
+    int processesCreated;
+    int totalInReadyQueue;
+    unsigned long migrations;
+    vector<SimTime>* departureLog;
+    unique_ptr<EventLog> eventLog;
+    unsigned long eventsHandled;
+    // Where the time goes (only with SCHEDSIM_INSTRUMENT, see Instrumentation.h)
+    EventProfile profile;
+    TimeWeightedAverage readyQueueSize, cpuBusy;
+    // Turnaround and waiting times are accumulated as each process departs
+    RunningStatistics turnaroundTimes, waitingTimes;
+    QuantileHistogram turnaroundHistogram, waitingHistogram;
+    // Whether the warm-up is still being looked for, and the processes and time deleted as warm-up once found
+    bool warmingUp;
+    WarmupDetector warmup;
+    int warmupProcesses;
+    SimTime warmupTime;
+
+    // MLFQ only: the quantum of each level, and the time of the next priority boost
+    vector<SimTime> levelQuanta;
+    SimTime nextBoost;
+    // CFS only: the target latency, and the virtual runtime of each ready queue (never decreasing), which new
+    // processes start at
+    SimTime targetLatency;
+    vector<SimTime> virtualClocks;
+
+    static_assert(ARRIVAL_HANDLER == (int) ARRIVAL && DEPARTURE_HANDLER == (int) DEPARTURE
+                  && TIMEOUT_HANDLER == (int) TIMEOUT && QUERY_HANDLER == (int) QUERY,
+                  "Event handlers must be profiled in the same order as EventType");
+
+    /**
+     * Handles the next event.
+     */
+    void step() {
+        // Get next event and update clock
+        Event current = eventQueue.getEvent();
+        clock = current.getTime();
+        eventsHandled++;
+
+        // Boost every process to the top level if it's time (MLFQ only), before anything is decided at this time
+        if constexpr (Policy::slicing == FEEDBACK_QUANTUM) {
+            if (clock >= nextBoost)
+                boost();
+        }
+
+        // Profile the queues as the event found them
+        uint64_t handlerStart = 0;
+        unsigned long eventQueueDepth = 0, readyQueueDepth = 0;
+        if constexpr (INSTRUMENTED) {
+            eventQueueDepth = eventQueue.size() + 1;
+            readyQueueDepth = waitingProcesses;
+            handlerStart = readTicks();
+        }
+
+        if (current.getType() == ARRIVAL)
+            handleArrival(current.getProcess());
+        else if (current.getType() == DEPARTURE)
+            handleDeparture(current.getCore());
+        else if (current.getType() == TIMEOUT)
+            handleTimeout(current.getCore());
+        else if (current.getType() == QUERY)
+            handleQuery();
+
+        if constexpr (INSTRUMENTED)
+            profile.recordEvent((ProfiledSection) current.getType(), readTicks() - handlerStart, eventQueueDepth,
+                                readyQueueDepth);
+
+        // Integrate the ready queue size and CPU utilization up to this event (they may have just changed)
+        if (exactStatistics) {
+            readyQueueSize.update(toSeconds(clock), waitingProcesses);
+            cpuBusy.update(toSeconds(clock), (double) busyCores / config.numCores);
+        }
+    }
+
+    /**
+     * Logs what happened to a process at the current time, if there is an event log.
+     * @param type What happened.
+     * @param p The process.
+     * @param core The core it happened on (NO_CORE for an arrival).
+     */
+    void logEvent(LogEventType type, ProcessId p, unsigned core) {
+        if (eventLog)
+            eventLog->append(clock, processes.getId(p), core, type);
+    }
+
+    /**
+     * Returns the ready queue a core takes processes from.
+     * @param core The core.
+     * @return The index of the core's ready queue.
+     */
+    size_t queueOf(unsigned core) {
+        return config.perCoreQueues ? core : 0;
+    }
+
+    /**
+     * Adds a process to a ready queue.
+     * @param queue The index of the ready queue.
+     * @param p The process to add.
+     */
+    void enqueue(size_t queue, ProcessId p) {
+        if (config.perCoreQueues)
+            queueLengths.erase({readyQueues[queue].size(), (unsigned) queue});
+        readyQueues[queue].add(p);
+        if (config.perCoreQueues)
+            queueLengths.insert({readyQueues[queue].size(), (unsigned) queue});
+        waitingProcesses++;
+    }
+
+    /**
+     * Removes the process at the front of a ready queue.
+     * @param queue The index of the ready queue, which must not be empty.
+     * @return The process that was at the front of the ready queue.
+     */
+    ProcessId dequeue(size_t queue) {
+        if (config.perCoreQueues)
+            queueLengths.erase({readyQueues[queue].size(), (unsigned) queue});
+        ProcessId p = readyQueues[queue].getFront();
+        if (config.perCoreQueues)
+            queueLengths.insert({readyQueues[queue].size(), (unsigned) queue});
+        waitingProcesses--;
+        return p;
+    }
+
+    /**
+     * Assigns a process to a core and schedules its tentative departure (may be unscheduled later due to preemption
+     * or timeout).
+     * @param core The core, which must not be running a process.
+     * @param p The process to assign to the core.
+     */
+    void assignCpu(unsigned core, ProcessId p) {
+        Core& c = cores[core];
+        processes.setLastTimeAssignedCpu(p, clock);
+        c.onCpu = p;
+        logEvent(LOG_DISPATCH, p, core);
+        SimTime departureTime = clock + processes.getServiceTimeLeft(p);
+
+        // With a slice per process, only the end of its slice is scheduled if it comes before the departure
+        if constexpr (slicedPerProcess) {
+            if constexpr (Policy::slicing == FAIR_SLICE) {
+                size_t queue = queueOf(core);
+                virtualClocks[queue] = std::max(virtualClocks[queue], processes.getVirtualRuntime(p));
+            }
+            SimTime slice = sliceOf(core, p);
+            if (slice > 0 && processes.getServiceTimeLeft(p) > slice) {
+                c.timeout = eventQueue.scheduleEvent(clock + slice, TIMEOUT, core);
+                processes.setDeparture(p, NO_EVENT);
+            } else {
+                c.timeout = NO_EVENT;
+                processes.setDeparture(p, eventQueue.scheduleEvent(departureTime, DEPARTURE, core));
+            }
+        } else {
+            processes.setDeparture(p, eventQueue.scheduleEvent(departureTime, DEPARTURE, core));
+        }
+
+        if constexpr (Policy::preemptive) {
+            if (!config.perCoreQueues) {
+                c.rank = Policy::slicing == FEEDBACK_QUANTUM ? processes.getLevel(p) : departureTime;
+                running.insert({c.rank, core});
+            }
+        }
+    }
+
+    /**
+     * Returns the slice a process gets on a core (MLFQ and CFS only): its level's quantum, or its share of the target
+     * latency among the processes that can run on the core, but no less than the quantum length.
+     * @param core The core.
+     * @param p The process being assigned the core.
+     * @return The length (in seconds) of the slice, <= 0 to run the process until it departs.
+     */
+    SimTime sliceOf(unsigned core, ProcessId p) {
+        if constexpr (Policy::slicing == FEEDBACK_QUANTUM)
+            return levelQuanta[processes.getLevel(p)];
+        // The processes waiting in the core's ready queue and the ones on the cores it serves share its cores
+        double servers = config.perCoreQueues ? 1 : config.numCores;
+        double runnable = (double) readyQueues[queueOf(core)].size() + (config.perCoreQueues ? 1 : busyCores);
+        return std::max(roundTicks(targetLatency * servers / runnable), quantumLength);
+    }
+
+    /**
+     * Forgets the tentative departure of the process on a core, once it has departed or been taken off the core.
+     * @param core The core.
+     */
+    void releaseCpu(unsigned core) {
+        if constexpr (Policy::preemptive) {
+            if (!config.perCoreQueues)
+                running.erase({cores[core].rank, core});
+        }
+    }
+
+    /**
+     * Takes the process on a core off of it, updating its remaining service time and unscheduling its tentative
+     * departure.
+     * @param core The core.
+     */
+    void unassignCpu(unsigned core) {
+        ProcessId onCpu = cores[core].onCpu;
+        logEvent(LOG_PREEMPTION, onCpu, core);
+        updateServiceTimeLeft(onCpu);
+        cancelEvent(processes.getDeparture(onCpu));
+        processes.setDeparture(onCpu, NO_EVENT);
+        releaseCpu(core);
+    }
+
+    /**
+     * Charges a process for the time it has been on its core since it was last assigned it.
+     * @param p The process on the core.
+     */
+    void updateServiceTimeLeft(ProcessId p) {
+        processes.setServiceTimeLeft(p, processes.getServiceTimeLeft(p)
+                                        - (clock - processes.getLastTimeAssignedCpu(p)));
+    }
+
+    /**
+     * If dynamic priority scheme, update statistics and resort a ready queue.
+     * @param queue The index of the ready queue.
+     */
+    void updatePriorities(size_t queue) {
+        if constexpr (Policy::dynamicPriority) {
+            uint64_t start = 0;
+            if constexpr (INSTRUMENTED)
+                start = readTicks();
+            readyQueues[queue].updateWaitTimes(clock);
+            readyQueues[queue].sort();
+            if constexpr (INSTRUMENTED)
+                profile.addSection(PRIORITY_UPDATE, readTicks() - start);
+        }
+    }
+
+    /**
+     * Unschedules a pending departure or timeout.
+     * @param handle The handle of the event.
+     */
+    void cancelEvent(EventHandle handle) {
+        if (handle == NO_EVENT)
+            return;
+        uint64_t start = 0;
+        if constexpr (INSTRUMENTED)
+            start = readTicks();
+        eventQueue.cancelEvent(handle);
+        if constexpr (INSTRUMENTED)
+            profile.addSection(EVENT_CANCELLATION, readTicks() - start);
+    }
+
+    /**
+     * Schedules a core's timeout at its next quantum boundary at or after the current time. Quantum boundaries fall
+     * every quantum from time 0, but timeouts are only scheduled while the core is busy.
+     * @param core The core.
+     */
+    void scheduleTimeout(unsigned core) {
+        Core& c = cores[core];
+        while (c.nextTimeout < clock)
+            c.nextTimeout += quantumLength;
+        c.timeout = eventQueue.scheduleEvent(c.nextTimeout, TIMEOUT, core);
+    }
+
+    /**
+     * Picks the busy core an arriving process is queued for (and, with preemption, may preempt): the core with the
+     * shortest ready queue, or with a shared ready queue the core whose process would finish last.
+     * @return The core.
+     */
+    unsigned targetCore() {
+        if (config.perCoreQueues)
+            return queueLengths.begin()->second;
+        if constexpr (Policy::preemptive)
+            return running.rbegin()->second;
+        return 0;
+    }
+
+    /**
+     * Handles a process' arrival.
+     * @param arriving The arriving process.
+     */
+    void handleArrival(ProcessId arriving) {
+        logEvent(LOG_ARRIVAL, arriving, NO_CORE);
+        // If a core is idle
+        if (!idleCores.empty()) {
+            unsigned core = idleCores.back();
+            idleCores.pop_back();
+            // Set core to busy and update idle time
+            busyCores++;
+            cores[core].idleTime += clock - cores[core].lastBusyTime;
+            // A new process starts level with the processes it will compete with (CFS only)
+            if constexpr (Policy::slicing == FAIR_SLICE)
+                processes.setVirtualRuntime(arriving, virtualClocks[queueOf(core)]);
+            // Assign arriving process to core
+            assignCpu(core, arriving);
+            // Start the quantum timer again (round robin only)
+            if constexpr (Policy::slicing == FIXED_QUANTUM) {
+                if (quantumLength > 0)
+                    scheduleTimeout(core);
+            }
+        }
+        // If every core is busy
+        else {
+            unsigned core = targetCore();
+            size_t queue = queueOf(core);
+            if constexpr (Policy::slicing == FAIR_SLICE)
+                processes.setVirtualRuntime(arriving, virtualClocks[queue]);
+            // Add arriving process to the ready queue
+            enqueue(queue, arriving);
+            updatePriorities(queue);
+
+            // If doing preemption, update onCpu's statistics
+            if constexpr (Policy::preemptive) {
+                ProcessId onCpu = cores[core].onCpu;
+                updateServiceTimeLeft(onCpu);
+
+                ProcessId candidate = readyQueues[queue].front();
+                // Compare process currently on the core with highest priority from the ready queue,
+                // if front of ready queue has a higher priority, we switch to that process
+                if (Comparator::compare(processes, candidate, onCpu)) {
+                    // Delete tentative departure (or end of slice) of process on the core
+                    logEvent(LOG_PREEMPTION, onCpu, core);
+                    cancelEvent(processes.getDeparture(onCpu));
+                    processes.setDeparture(onCpu, NO_EVENT);
+                    if constexpr (slicedPerProcess) {
+                        cancelEvent(cores[core].timeout);
+                        cores[core].timeout = NO_EVENT;
+                    }
+                    releaseCpu(core);
+                    // Move process from the core to ready queue
+                    dequeue(queue);
+                    enqueue(queue, onCpu);
+                    // Assign candidate to the core and schedule its tentative departure
+                    assignCpu(core, candidate);
+                }
+                // If front of ready queue is not higher priority, leave it there
+                else {
+                    processes.setLastTimeAssignedCpu(onCpu, clock);
+                }
+            }
+        }
+
+        // Schedule next process arrival (unless the workload has run out)
+        int nextId = processes.getId(arriving) + 1;
+        double interArrivalTime, serviceTime;
+        if (workload.next(interArrivalTime, serviceTime)) {
+            SimTime nextArrivalTime = clock + toSimTime(interArrivalTime);
+            eventQueue.scheduleEvent(nextArrivalTime, ARRIVAL,
+                                     processes.acquire(nextId, nextArrivalTime, toServiceTime(serviceTime)));
+            processesCreated++;
+        }
+    }
+
+    /**
+     * Handles the departure of the process on a core.
+     * @param core The core the departing process was running on.
+     */
+    void handleDeparture(unsigned core) {
+        ProcessId departing = cores[core].onCpu;
+        // Increment number of processes simulated at each departure
+        processesSimulated++;
+        // Update completion time of departing process, add its turnaround and waiting times to the statistics,
+        // and free it
+        processes.setCompletionTime(departing, clock);
+        logEvent(LOG_DEPARTURE, departing, core);
+        SimTime turnaroundTicks = processes.getCompletionTime(departing) - processes.getArrivalTime(departing);
+        double turnaround = toSeconds(turnaroundTicks);
+        double waiting = toWaitingSeconds(turnaroundTicks, processes.getServiceTime(departing), clock);
+        turnaroundTimes.add(turnaround);
+        turnaroundHistogram.add(turnaround);
+        waitingTimes.add(waiting);
+        waitingHistogram.add(waiting);
+        processes.release(departing);
+        releaseCpu(core);
+        if (departureLog != nullptr)
+            departureLog->push_back(clock);
+        // Delete the warm-up once it's over, giving up if it isn't over by the time the configured number of processes
+        // have departed or the detector gives up
+        if (warmingUp) {
+            if (warmup.add(turnaround))
+                deleteWarmupStatistics();
+            else if (processesSimulated >= config.numProcesses || warmup.hasGivenUp())
+                warmingUp = false;
+        }
+
+        // If the core's ready queue is empty, steal from the longest one (per-core ready queues only)
+        size_t queue = queueOf(core);
+        if (config.perCoreQueues && readyQueues[queue].empty())
+            queue = queueLengths.rbegin()->second;
+
+        // If every ready queue is empty, set core to idle and update statistics
+        if (readyQueues[queue].empty()) {
+            Core& c = cores[core];
+            c.onCpu = NO_PROCESS;
+            c.lastBusyTime = clock;
+            busyCores--;
+            idleCores.push_back(core);
+            // No timeouts while the core is idle (a slice per process never outlasts its departure)
+            if constexpr (Policy::slicing == FIXED_QUANTUM) {
+                cancelEvent(c.timeout);
+                c.timeout = NO_EVENT;
+            }
+        }
+        // Otherwise put next process from the ready queue on the core and schedule its tentative departure
+        else {
+            updatePriorities(queue);
+            ProcessId next = dequeue(queue);
+            if (queue != queueOf(core)) {
+                migrations++;
+                // Carry the process' virtual runtime over relative to the queue it joins (CFS only)
+                if constexpr (Policy::slicing == FAIR_SLICE)
+                    processes.setVirtualRuntime(next, processes.getVirtualRuntime(next) - virtualClocks[queue]
+                                                      + virtualClocks[queueOf(core)]);
+            }
+            assignCpu(core, next);
+        }
+    }
+
+    /**
+     * Handles the end of a quantum or slice on a core (time sliced schedulers only), switching to the process at the
+     * front of the core's ready queue. Only scheduled while the core is busy.
+     * @param core The core.
+     */
+    void handleTimeout(unsigned core) {
+        ProcessId onCpu = cores[core].onCpu;
+        size_t queue = queueOf(core);
+
+        if constexpr (slicedPerProcess) {
+            // The process has used up its slice (its departure isn't scheduled, since it would come later)
+            SimTime ran = clock - processes.getLastTimeAssignedCpu(onCpu);
+            logEvent(LOG_PREEMPTION, onCpu, core);
+            cores[core].timeout = NO_EVENT;
+            updateServiceTimeLeft(onCpu);
+            releaseCpu(core);
+            // Drop it a level (MLFQ), or charge the slice to its virtual runtime (CFS)
+            if constexpr (Policy::slicing == FEEDBACK_QUANTUM) {
+                if (processes.getLevel(onCpu) + 1 < levelQuanta.size())
+                    processes.setLevel(onCpu, processes.getLevel(onCpu) + 1);
+            } else {
+                processes.setVirtualRuntime(onCpu, processes.getVirtualRuntime(onCpu) + ran);
+            }
+            enqueue(queue, onCpu);
+            updatePriorities(queue);
+            // Assign front of ready queue to the core, with a new slice
+            assignCpu(core, dequeue(queue));
+        } else {
+            // Update current process' remaining service time, unschedule tentative departure, and place in ready queue
+            unassignCpu(core);
+            enqueue(queue, onCpu);
+            updatePriorities(queue);
+
+            // Assign front of ready queue to the core, schedule tentative departure, and update last time assigned CPU
+            assignCpu(core, dequeue(queue));
+
+            // Schedule next timeout event
+            cores[core].nextTimeout = clock + quantumLength;
+            scheduleTimeout(core);
+        }
+    }
+
+    /**
+     * Boosts every process, waiting or running, to the highest priority level (MLFQ only). Running processes finish
+     * their current slices.
+     */
+    void boost() {
+        for (auto& queue : readyQueues)
+            queue.boost();
+        for (unsigned core = 0; core < cores.size(); core++) {
+            if (cores[core].onCpu == NO_PROCESS)
+                continue;
+            releaseCpu(core);
+            processes.setLevel(cores[core].onCpu, 0);
+            if constexpr (Policy::preemptive) {
+                if (!config.perCoreQueues) {
+                    cores[core].rank = 0;
+                    running.insert({0, core});
+                }
+            }
+        }
+        while (nextBoost <= clock)
+            nextBoost += boostInterval;
+    }
+
+    /**
+     * Forgets every statistic gathered so far, so they are gathered from the current time on, as if the simulation had
+     * started in the state it is in now. The configured number of processes is counted from now on too.
+     */
+    void deleteWarmupStatistics() {
+        warmingUp = false;
+        warmupProcesses += processesSimulated;
+        warmupTime = clock;
+
+        // Processes created and simulated are counted from here on, so every process still in the system is counted
+        processesCreated -= processesSimulated;
+        processesSimulated = 0;
+        turnaroundTimes.reset();
+        waitingTimes.reset();
+        turnaroundHistogram.reset();
+        waitingHistogram.reset();
+        readyQueueSize.reset(toSeconds(clock));
+        cpuBusy.reset(toSeconds(clock));
+        totalInReadyQueue = 0;
+        migrations = 0;
+        for (auto& c : cores) {
+            c.idleTime = 0;
+            if (c.onCpu == NO_PROCESS)
+                c.lastBusyTime = clock;
+        }
+    }
+
+    /**
+     * Handles a query, sampling the ready queue size.
+     */
+    void handleQuery() {
+        // Update statistics
+        totalInReadyQueue += waitingProcesses;
+        // Schedule next query event
+        eventQueue.scheduleEvent(clock + queryInterval, QUERY);
+    }
+
+    /**
+     * Returns whether there are more processes to simulate (a process is created when its arrival is scheduled, so
+     * all processes created have departed only once the workload has run out).
+     * @return True if the simulation isn't over.
+     */
+    bool unfinished() {
+        return processesSimulated < config.numProcesses && processesSimulated < processesCreated
+               && !eventQueue.empty();
+    }
+
+    /*
+     * Checkpoints hold the logical state of the simulation rather than the layout of its data structures: every
+     * process in the system is numbered, and the ready queues, cores and pending events refer to processes by number.
+     * Restoring adds them back one by one, so a checkpoint resumes on any event queue and process table, and under
+     * different scheduler parameters.
+     */
+
+    /**
+     * A process in a checkpoint.
+     */
+    struct CheckpointProcess {
+        int32_t id;
+        uint32_t level;
+        SimTime arrivalTime;
+        SimTime serviceTime;
+        SimTime waitTime;
+        SimTime lastTimeAssignedCpu;
+        SimTime serviceTimeLeft;
+        SimTime virtualRuntime;
+    };
+
+    /**
+     * A core in a checkpoint (the number of the process on it, or NO_PROCESS if idle).
+     */
+    struct CheckpointCore {
+        uint32_t onCpu;
+        uint32_t reserved;
+        SimTime nextTimeout;
+        SimTime rank;
+        SimTime lastBusyTime;
+        SimTime idleTime;
+    };
+
+    /**
+     * A pending event in a checkpoint (its subject is the number of the arriving process, or the core).
+     */
+    struct CheckpointEvent {
+        SimTime time;
+        uint32_t type;
+        uint32_t subject;
+    };
+
+    /**
+     * Saves the whole state of the simulation to a checkpoint file, to be resumed by restore().
+     * @param path The path of the checkpoint file.
+     * @throws runtime_error If the file can't be written.
+     */
+    void saveCheckpoint(const string& path) {
+        CheckpointWriter out;
+        // What the state only makes sense with, checked when it's resumed
+        out.put((uint32_t) config.numCores);
+        out.put((uint8_t) config.perCoreQueues);
+        out.put(queryInterval);
+        out.put(quantumLength);
+
+        out.put(clock);
+        out.put(processesSimulated);
+        out.put(processesCreated);
+        out.put(totalInReadyQueue);
+        out.put((uint64_t) migrations);
+        out.put((uint64_t) eventsHandled);
+        out.put((uint8_t) warmingUp);
+        out.put(warmupProcesses);
+        out.put(warmupTime);
+        out.put(nextBoost);
+        out.putVector(virtualClocks);
+
+        // Number every process in the system in the order they are found: the ones yet to arrive, then the waiting
+        // ones queue by queue, then the ones on the cores
+        vector<ProcessId> live;
+        unordered_map<ProcessId, uint32_t> numbers;
+        auto number = [&](ProcessId p) {
+            auto inserted = numbers.insert({p, (uint32_t) live.size()});
+            if (inserted.second)
+                live.push_back(p);
+            return inserted.first->second;
+        };
+        vector<CheckpointEvent> events;
+        for (const Event& e : eventQueue.pendingEvents())
+            events.push_back({e.getTime(), (uint32_t) e.getType(),
+                              e.getType() == ARRIVAL ? number(e.getProcess()) : e.getCore()});
+        vector<vector<uint32_t>> queued(readyQueues.size());
+        for (size_t q = 0; q < readyQueues.size(); q++)
+            readyQueues[q].forEachProcess([&](ProcessId p) { queued[q].push_back(number(p)); });
+        vector<CheckpointCore> savedCores;
+        for (const Core& c : cores)
+            savedCores.push_back({c.onCpu == NO_PROCESS ? NO_PROCESS : number(c.onCpu), 0, c.nextTimeout, c.rank,
+                                  c.lastBusyTime, c.idleTime});
+
+        vector<CheckpointProcess> savedProcesses;
+        for (ProcessId p : live)
+            savedProcesses.push_back({processes.getId(p), processes.getLevel(p), processes.getArrivalTime(p),
+                                      processes.getServiceTime(p), processes.getWaitTime(p),
+                                      processes.getLastTimeAssignedCpu(p), processes.getServiceTimeLeft(p),
+                                      processes.getVirtualRuntime(p)});
+        out.putVector(savedProcesses);
+        out.putVector(savedCores);
+        out.putVector(idleCores);
+        for (const auto& queue : queued)
+            out.putVector(queue);
+        out.putVector(events);
+
+        out.put(readyQueueSize);
+        out.put(cpuBusy);
+        out.put(turnaroundTimes);
+        out.put(waitingTimes);
+        turnaroundHistogram.save(out);
+        waitingHistogram.save(out);
+        warmup.save(out);
+        workload.save(out);
+        out.save(path, POLICY_FINGERPRINT);
+    }
+
+    /**
+     * Replaces the state of the simulation, which must not have started, with the state saved in a checkpoint file.
+     * The checkpoint must have been saved by the same scheduler, with the same cores, query interval and workload,
+     * but the other parameters of the scheduler may differ: the processes carry on under the new ones.
+     * @param path The path of the checkpoint file.
+     * @throws runtime_error If the file can't be read, isn't a valid checkpoint, or was saved by a simulation that
+     * can't be resumed with this configuration.
+     */
+    void restore(const string& path) {
+        CheckpointReader in(path);
+        if (in.getPolicy() != POLICY_FINGERPRINT)
+            throw runtime_error("Checkpoint \"" + path + "\" was saved by a different scheduler");
+        uint32_t numCores = in.get<uint32_t>();
+        bool perCoreQueues = in.get<uint8_t>() != 0;
+        if (numCores != config.numCores || perCoreQueues != config.perCoreQueues)
+            throw runtime_error("Checkpoint \"" + path + "\" was saved with different cores or ready queues");
+        if (in.get<SimTime>() != queryInterval)
+            throw runtime_error("Checkpoint \"" + path + "\" was saved with a different query interval");
+        SimTime savedQuantumLength = in.get<SimTime>();
+        if constexpr (Policy::slicing == FIXED_QUANTUM) {
+            if ((savedQuantumLength > 0) != (quantumLength > 0))
+                throw runtime_error("Round robin can't be resumed with time slicing turned on or off");
+        }
+
+        clock = in.get<SimTime>();
+        processesSimulated = in.get<int>();
+        processesCreated = in.get<int>();
+        totalInReadyQueue = in.get<int>();
+        migrations = in.get<uint64_t>();
+        eventsHandled = in.get<uint64_t>();
+        bool savedWarmingUp = in.get<uint8_t>() != 0;
+        warmupProcesses = in.get<int>();
+        warmupTime = in.get<SimTime>();
+        SimTime savedNextBoost = in.get<SimTime>();
+        vector<SimTime> savedVirtualClocks;
+        in.getVector(savedVirtualClocks);
+        if (savedVirtualClocks.size() != virtualClocks.size())
+            in.fail();
+        virtualClocks = savedVirtualClocks;
+
+        // Take every process back into the table, each of which must turn up in exactly one place below
+        vector<CheckpointProcess> savedProcesses;
+        in.getVector(savedProcesses);
+        vector<ProcessId> live;
+        vector<bool> found(savedProcesses.size(), false);
+        for (const CheckpointProcess& saved : savedProcesses) {
+            ProcessId p = processes.acquire(saved.id, saved.arrivalTime, saved.serviceTime);
+            processes.setWaitTime(p, saved.waitTime);
+            processes.setLastTimeAssignedCpu(p, saved.lastTimeAssignedCpu);
+            processes.setServiceTimeLeft(p, saved.serviceTimeLeft);
+            processes.setVirtualRuntime(p, saved.virtualRuntime);
+            // Fewer MLFQ levels than before leave the processes below them on the lowest
+            processes.setLevel(p, levelQuanta.empty() ? saved.level
+                                                      : std::min(saved.level, (uint32_t) levelQuanta.size() - 1));
+            live.push_back(p);
+        }
+        auto take = [&](uint32_t number) {
+            if (number >= live.size() || found[number])
+                in.fail();
+            found[number] = true;
+            return live[number];
+        };
+
+        vector<CheckpointCore> savedCores;
+        in.getVector(savedCores);
+        if (savedCores.size() != cores.size())
+            in.fail();
+        busyCores = 0;
+        for (unsigned core = 0; core < cores.size(); core++) {
+            const CheckpointCore& saved = savedCores[core];
+            Core& c = cores[core];
+            c.onCpu = saved.onCpu == NO_PROCESS ? NO_PROCESS : take(saved.onCpu);
+            c.nextTimeout = saved.nextTimeout;
+            c.rank = saved.rank;
+            c.lastBusyTime = saved.lastBusyTime;
+            c.idleTime = saved.idleTime;
+            if (c.onCpu == NO_PROCESS)
+                continue;
+            busyCores++;
+            if constexpr (Policy::slicing == FEEDBACK_QUANTUM)
+                c.rank = processes.getLevel(c.onCpu);
+            if constexpr (Policy::preemptive) {
+                if (!config.perCoreQueues)
+                    running.insert({c.rank, core});
+            }
+        }
+        in.getVector(idleCores);
+        vector<bool> idle(cores.size(), false);
+        for (unsigned core : idleCores) {
+            if (core >= cores.size() || idle[core] || cores[core].onCpu != NO_PROCESS)
+                in.fail();
+            idle[core] = true;
+        }
+        if (idleCores.size() != cores.size() - busyCores)
+            in.fail();
+
+        // Refill the ready queues as of the checkpoint's time
+        queueLengths.clear();
+        waitingProcesses = 0;
+        for (size_t queue = 0; queue < readyQueues.size(); queue++) {
+            vector<uint32_t> queued;
+            in.getVector(queued);
+            if constexpr (Policy::dynamicPriority)
+                readyQueues[queue].updateWaitTimes(clock);
+            for (uint32_t number : queued)
+                readyQueues[queue].add(take(number));
+            waitingProcesses += queued.size();
+            if (config.perCoreQueues)
+                queueLengths.insert({readyQueues[queue].size(), (unsigned) queue});
+        }
+
+        // Schedule the pending events again in the order they were to be handled, so ties are broken the same way
+        vector<CheckpointEvent> events;
+        in.getVector(events);
+        for (const CheckpointEvent& e : events) {
+            if (e.time < clock || e.type > QUERY)
+                in.fail();
+            EventType type = (EventType) e.type;
+            if (type == ARRIVAL) {
+                eventQueue.scheduleEvent(e.time, ARRIVAL, take(e.subject));
+            } else if (type == QUERY) {
+                eventQueue.scheduleEvent(e.time, QUERY);
+            } else {
+                if (e.subject >= cores.size() || cores[e.subject].onCpu == NO_PROCESS)
+                    in.fail();
+                Core& c = cores[e.subject];
+                if (type == DEPARTURE) {
+                    if (processes.getDeparture(c.onCpu) != NO_EVENT)
+                        in.fail();
+                    processes.setDeparture(c.onCpu, eventQueue.scheduleEvent(e.time, DEPARTURE, e.subject));
+                } else {
+                    if (c.timeout != NO_EVENT)
+                        in.fail();
+                    c.timeout = eventQueue.scheduleEvent(e.time, TIMEOUT, e.subject);
+                }
+            }
+        }
+        if (std::find(found.begin(), found.end(), false) != found.end())
+            in.fail();
+
+        readyQueueSize = in.get<TimeWeightedAverage>();
+        cpuBusy = in.get<TimeWeightedAverage>();
+        turnaroundTimes = in.get<RunningStatistics>();
+        waitingTimes = in.get<RunningStatistics>();
+        turnaroundHistogram.load(in);
+        waitingHistogram.load(in);
+        warmup.load(in);
+        workload.load(in);
+        in.finish();
+
+        // Carry on under the new configuration: a boost interval starts counting from now if boosts were off, and the
+        // warm-up is only looked for if it still is
+        if (boostInterval <= 0)
+            nextBoost = NEVER;
+        else if (savedNextBoost == NEVER)
+            nextBoost = clock + boostInterval;
+        else
+            nextBoost = savedNextBoost;
+        warmingUp = savedWarmingUp && config.deleteWarmup;
+        if (config.resetStatistics)
+            deleteWarmupStatistics();
+    }
+
+};
+
+/**
+ * Simulates a priority based scheduling algorithm.
+ * @tparam Policy The SchedulingPolicy describing the scheduler (FCFSPolicy, SRTFPolicy, HRRNPolicy, RRPolicy,
+ * MLFQPolicy or CFSPolicy).
+ * @tparam EventQueueType The event queue implementation to use (EventQueue, HeapEventQueue or CalendarEventQueue).
+ * @tparam Workload The source of the processes (SyntheticWorkload or TraceWorkload).
+ * @param config The parameters of the simulation.
+ * @param workload The source of the processes to simulate.
+ * @return The statistics of the simulation.
+ */
+template <class Policy, class EventQueueType = EventQueue, class Workload = SyntheticWorkload>
+Statistics simulatePriorityBased(const SimulationConfig& config, Workload& workload) {
+    Simulation<Policy, EventQueueType, Workload> simulation(config, workload);
+    if constexpr (INSTRUMENTED) {
+        // Count the hardware events of the run itself
+        HardwareCounters counters;
+        counters.start();
+        Statistics s = simulation.run();
+        s.profile.hardware = counters.stop();
+        return s;
+    }
+    return simulation.run();
+}
+
+/**
+ * The event queue implementations a simulation can run on.
+ */
+enum EventQueueBackend {
+    SET_QUEUE, HEAP_QUEUE, CALENDAR_QUEUE
+};
+
+/**
+ * An empty value standing for a type, so a type chosen at runtime can be passed to a generic lambda.
+ * @tparam Type The type.
+ */
+template <class Type>
+struct TypeTag {
+    typedef Type type;
+};
+
+/**
+ * Calls a generic visitor with the SchedulingPolicy of one of the available schedulers.
+ * @param scheduler The scheduler, numbered as on the command line: (1) FCFS, (2) SRTF, (3) HRRN, (4) RR, (5) MLFQ,
+ * (6) CFS.
+ * @param visit The visitor, called with a TypeTag of the policy.
+ * @return What the visitor returns, or a value-initialized result for an unknown scheduler.
+ */
+template <class Visitor>
+auto visitPolicy(int scheduler, Visitor&& visit) -> decltype(visit(TypeTag<FCFSPolicy>())) {
+    switch (scheduler) {
+        case 1:
+            return visit(TypeTag<FCFSPolicy>());
+        case 2:
+            return visit(TypeTag<SRTFPolicy>());
+        case 3:
+            return visit(TypeTag<HRRNPolicy>());
+        case 4:
+            return visit(TypeTag<RRPolicy>());
+        case 5:
+            return visit(TypeTag<MLFQPolicy>());
+        case 6:
+            return visit(TypeTag<CFSPolicy>());
+        default:
+            return {};
+    }
+}
+
+/**
+ * Calls a generic visitor with one of the event queue implementations.
+ * @param backend The event queue implementation.
+ * @param visit The visitor, called with a TypeTag of the event queue type.
+ * @return What the visitor returns.
+ */
+template <class Visitor>
+auto visitEventQueue(EventQueueBackend backend, Visitor&& visit) -> decltype(visit(TypeTag<EventQueue>())) {
+    switch (backend) {
+        case HEAP_QUEUE:
+            return visit(TypeTag<HeapEventQueue>());
+        case CALENDAR_QUEUE:
+            return visit(TypeTag<CalendarEventQueue>());
+        default:
+            return visit(TypeTag<EventQueue>());
+    }
+}
+
+/**
+ * Simulates one of the available schedulers on the given workload. The scheduler and event queue implementation are
+ * picked at runtime.
+ * @tparam Workload The source of the processes (see Workload.h).
+ * @param backend The event queue implementation to use.
+ * @param scheduler The scheduler to simulate, numbered as on the command line (1-6).
+ * @param config The parameters of the simulation.
+ * @param workload The processes to simulate.
+ * @return The statistics of the simulation.
+ */
+template <class Workload>
+Statistics simulateWorkload(EventQueueBackend backend, int scheduler, const SimulationConfig& config,
+                            Workload& workload) {
+    return visitEventQueue(backend, [&](auto queue) {
+        return visitPolicy(scheduler, [&](auto policy) {
+            return simulatePriorityBased<typename decltype(policy)::type, typename decltype(queue)::type>(
+                    config, workload);
+        });
+    });
+}
+
+/**
+ * Simulates one of the available schedulers, replaying the configured trace file or, if there is none, generating
+ * processes from the random stream. The scheduler and event queue implementation are picked at runtime.
+ * @param backend The event queue implementation to use.
+ * @param scheduler The scheduler to simulate, numbered as on the command line (1-6).
+ * @param config The parameters of the simulation.
+ * @param rng The random stream to draw inter-arrival and service times from (unused when replaying a trace).
+ * @return The statistics of the simulation.
+ * @throws runtime_error If the trace file can't be opened or isn't a valid trace.
+ */
+inline Statistics simulate(EventQueueBackend backend, int scheduler, const SimulationConfig& config,
+                           RandomStream& rng) {
+    if (!config.tracePath.empty()) {
+        TraceWorkload workload(config.tracePath);
+        return simulateWorkload(backend, scheduler, config, workload);
+    }
+    SyntheticWorkload workload(rng, config.arrivalRate, config.serviceTime);
+    return simulateWorkload(backend, scheduler, config, workload);
+}
+
+#endif //CS4328_PROJECT1_SIMULATION_H
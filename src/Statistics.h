@@ -0,0 +1,204 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_STATISTICS_H
+#define CS4328_PROJECT1_STATISTICS_H
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "StreamingStatistics.h"
+#include "Instrumentation.h"
+
+using std::vector;
+
+/**
+ * The quantiles of turnaround and waiting time reported in Statistics (p50, p95, p99 and p99.9).
+ */
+const double STATISTICS_QUANTILES[] {0.5, 0.95, 0.99, 0.999};
+const int NUM_STATISTICS_QUANTILES = 4;
+
+/**
+ * Simple structure to hold statistics about a scheduling algorithms performance.
+ */
+struct Statistics {
+    double avgTurnaroundTime;
+    double throughput;
+    double avgCpuUtil;
+    double avgReadyQueueSize;
+
+    // Spread and tail of the turnaround time, and of the waiting time (turnaround time minus service time)
+    double turnaroundTimeStdDev;
+    double minTurnaroundTime;
+    double maxTurnaroundTime;
+    double turnaroundTimeQuantiles[NUM_STATISTICS_QUANTILES];
+    double avgWaitingTime;
+    double waitingTimeQuantiles[NUM_STATISTICS_QUANTILES];
+
+    // Utilization of each CPU core (avgCpuUtil is their mean), and the number of processes stolen by another core
+    vector<double> coreUtilization;
+    unsigned long migrations;
+
+    // The number of processes and time (in seconds) deleted as warm-up before the statistics were gathered
+    int warmupProcesses;
+    double warmupTime;
+
+    // Where the time went (only with SCHEDSIM_INSTRUMENT)
+    EventProfile profile;
+
+    /**
+     * Calls a function with the name and value of every scalar statistic (everything but the per-core utilizations,
+     * migrations and profile), always in the same order.
+     * @param function The function, called as function(const char* name, double& value).
+     */
+    template <class Function>
+    void forEachScalar(Function&& function) {
+        const char* turnaroundNames[] {"Turnaround p50", "Turnaround p95", "Turnaround p99", "Turnaround p99.9"};
+        const char* waitingNames[] {"Waiting p50", "Waiting p95", "Waiting p99", "Waiting p99.9"};
+        function("Avg. Turnaround Time", this->avgTurnaroundTime);
+        function("Throughput", this->throughput);
+        function("Avg. CPU Util", this->avgCpuUtil);
+        function("Avg. in Ready Queue", this->avgReadyQueueSize);
+        function("Turnaround Time Std", this->turnaroundTimeStdDev);
+        function("Turnaround Time Min", this->minTurnaroundTime);
+        function("Turnaround Time Max", this->maxTurnaroundTime);
+        function("Avg. Waiting Time", this->avgWaitingTime);
+        for (int i = 0; i < NUM_STATISTICS_QUANTILES; i++)
+            function(turnaroundNames[i], this->turnaroundTimeQuantiles[i]);
+        for (int i = 0; i < NUM_STATISTICS_QUANTILES; i++)
+            function(waitingNames[i], this->waitingTimeQuantiles[i]);
+    }
+
+    /**
+     * Prints a string representation of the statistics, followed by the profile if instrumented.
+     */
+    void display() {
+        printf("Avg. Turnaround Time : %6.3f\n"
+               "          Throughput : %6.3f\n"
+               "       Avg. CPU Util : %6.3f\n"
+               " Avg. in Ready Queue : %6.3f\n",
+               this->avgTurnaroundTime, this->throughput, this->avgCpuUtil, this->avgReadyQueueSize
+        );
+        printf(" Turnaround Time Std : %6.3f\n"
+               "  Turnaround Min/Max : %6.3f / %.3f\n"
+               " Turnaround Time Pct : %6.3f %6.3f %6.3f %6.3f  (p50 p95 p99 p99.9)\n"
+               "   Avg. Waiting Time : %6.3f\n"
+               "    Waiting Time Pct : %6.3f %6.3f %6.3f %6.3f  (p50 p95 p99 p99.9)\n",
+               this->turnaroundTimeStdDev, this->minTurnaroundTime, this->maxTurnaroundTime,
+               this->turnaroundTimeQuantiles[0], this->turnaroundTimeQuantiles[1], this->turnaroundTimeQuantiles[2],
+               this->turnaroundTimeQuantiles[3], this->avgWaitingTime,
+               this->waitingTimeQuantiles[0], this->waitingTimeQuantiles[1], this->waitingTimeQuantiles[2],
+               this->waitingTimeQuantiles[3]
+        );
+        if (this->coreUtilization.size() > 1) {
+            printf("               Cores : %6zu\n"
+                   "   Core Util Min/Max : %6.3f / %.3f\n"
+                   "          Migrations : %6lu\n",
+                   this->coreUtilization.size(),
+                   *std::min_element(this->coreUtilization.begin(), this->coreUtilization.end()),
+                   *std::max_element(this->coreUtilization.begin(), this->coreUtilization.end()),
+                   this->migrations
+            );
+        }
+        if (this->warmupProcesses > 0)
+            printf("     Warm-up Deleted : %6d processes, %.3f s\n", this->warmupProcesses, this->warmupTime);
+        if (INSTRUMENTED)
+            this->profile.display();
+    }
+};
+
+
+/**
+ * The raw totals behind the Statistics of one or more simulations. The totals of simulations run side by side over the
+ * same span of time (such as the clusters of a ClusterSimulation) can be combined with merge() before finish() turns
+ * them into Statistics.
+ */
+struct StatisticsAccumulator {
+    // The number of simulations combined, and whether their ready queue size and CPU utilization were integrated
+    // exactly (rather than sampled)
+    unsigned numSimulations = 0;
+    bool exactStatistics = false;
+
+    int processesSimulated = 0;
+    RunningStatistics turnaroundTimes, waitingTimes;
+    QuantileHistogram turnaroundHistogram, waitingHistogram;
+
+    // Idle time (in seconds) of every core, and the number of processes stolen by another core
+    vector<double> coreIdleTimes;
+    unsigned long migrations = 0;
+
+    // Integrals over time of the ready queue size and of the fraction of cores busy (exact statistics), or the sum of
+    // the ready queue size samples (sampled statistics)
+    double readyQueueIntegral = 0;
+    double cpuBusyIntegral = 0;
+    long totalInReadyQueue = 0;
+
+    EventProfile profile;
+
+    /**
+     * Adds the totals of another simulation to these.
+     * @param other The totals to add.
+     */
+    void merge(const StatisticsAccumulator& other) {
+        if (numSimulations == 0) {
+            *this = other;
+            return;
+        }
+        numSimulations += other.numSimulations;
+        processesSimulated += other.processesSimulated;
+        turnaroundTimes.merge(other.turnaroundTimes);
+        waitingTimes.merge(other.waitingTimes);
+        turnaroundHistogram.merge(other.turnaroundHistogram);
+        waitingHistogram.merge(other.waitingHistogram);
+        coreIdleTimes.insert(coreIdleTimes.end(), other.coreIdleTimes.begin(), other.coreIdleTimes.end());
+        migrations += other.migrations;
+        readyQueueIntegral += other.readyQueueIntegral;
+        cpuBusyIntegral += other.cpuBusyIntegral;
+        totalInReadyQueue += other.totalInReadyQueue;
+        profile.merge(other.profile);
+    }
+
+    /**
+     * Calculates the statistics from the totals.
+     * @param startTime The time (in seconds) the totals were accumulated from.
+     * @param endTime The time (in seconds) the totals were accumulated up to.
+     * @param queryInterval The interval (in seconds) the ready queue size was sampled at (if not exact).
+     * @return The statistics.
+     */
+    Statistics finish(double startTime, double endTime, double queryInterval) const {
+        double elapsed = endTime - startTime;
+
+        Statistics s {};
+        s.avgTurnaroundTime = turnaroundTimes.getMean();
+        s.throughput = processesSimulated / elapsed;
+
+        double totalUtil = 0;
+        for (double idleTime : coreIdleTimes) {
+            s.coreUtilization.push_back(1 - (idleTime / elapsed));
+            totalUtil += s.coreUtilization.back();
+        }
+        s.migrations = migrations;
+
+        if (exactStatistics) {
+            s.avgCpuUtil = cpuBusyIntegral / (elapsed * numSimulations);
+            s.avgReadyQueueSize = readyQueueIntegral / elapsed;
+        } else {
+            s.avgCpuUtil = totalUtil / coreIdleTimes.size();
+            s.avgReadyQueueSize = (double) totalInReadyQueue / (elapsed / queryInterval);
+        }
+        s.turnaroundTimeStdDev = turnaroundTimes.getStdDev();
+        s.minTurnaroundTime = turnaroundTimes.getMin();
+        s.maxTurnaroundTime = turnaroundTimes.getMax();
+        s.avgWaitingTime = waitingTimes.getMean();
+        for (int i = 0; i < NUM_STATISTICS_QUANTILES; i++) {
+            s.turnaroundTimeQuantiles[i] = turnaroundHistogram.quantile(STATISTICS_QUANTILES[i]);
+            s.waitingTimeQuantiles[i] = waitingHistogram.quantile(STATISTICS_QUANTILES[i]);
+        }
+        s.profile = profile;
+        return s;
+    }
+};
+
+#endif //CS4328_PROJECT1_STATISTICS_H
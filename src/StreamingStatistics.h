@@ -0,0 +1,440 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_STREAMINGSTATISTICS_H
+#define CS4328_PROJECT1_STREAMINGSTATISTICS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Checkpoint.h"
+
+using std::vector;
+
+/**
+ * Accumulates the count, mean, variance, minimum and maximum of a stream of values one value at a time, using
+ * Welford's algorithm so the variance stays accurate over long streams.
+ */
+class RunningStatistics {
+
+public:
+
+    RunningStatistics() {
+        reset();
+    }
+
+    /**
+     * Adds a value to the statistics.
+     * @param x The value to add.
+     */
+    void add(double x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+
+    /**
+     * Combines another set of statistics into this one, as if all its values had been added here.
+     * @param other The statistics to combine.
+     */
+    void merge(const RunningStatistics& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        double total = (double) count + (double) other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * count * other.count / total;
+        count += other.count;
+        if (other.min < min) min = other.min;
+        if (other.max > max) max = other.max;
+    }
+
+    /**
+     * Forgets every value added so far.
+     */
+    void reset() {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        min = INFINITY;
+        max = -INFINITY;
+    }
+
+    unsigned long getCount() const { return this->count; }
+    double getMean() const { return this->mean; }
+    double getMin() const { return this->count > 0 ? this->min : 0; }
+    double getMax() const { return this->count > 0 ? this->max : 0; }
+
+    /**
+     * Returns the sample variance of the values.
+     * @return The sample variance, or 0 if fewer than two values were added.
+     */
+    double getVariance() const { return this->count > 1 ? this->m2 / (this->count - 1) : 0; }
+
+    /**
+     * Returns the sample standard deviation of the values.
+     * @return The sample standard deviation, or 0 if fewer than two values were added.
+     */
+    double getStdDev() const { return std::sqrt(getVariance()); }
+
+private:
+    unsigned long count;
+    double mean;
+    double m2;
+    double min;
+    double max;
+
+};
+
+/**
+ * A fixed-memory histogram for estimating quantiles of a stream of non-negative values, in the style of an HDR
+ * histogram. Each power of two is split into equally sized sub-buckets, so every value is recorded with a relative
+ * error of at most 1/SUB_BUCKETS (under 1%) no matter how large or small it is, and the memory used never grows.
+ */
+class QuantileHistogram {
+
+public:
+
+    QuantileHistogram() : counts(NUM_EXPONENTS * SUB_BUCKETS, 0) {
+        this->total = 0;
+        this->zeros = 0;
+    }
+
+    /**
+     * Records a value in the histogram.
+     * @param x The value to record (values <= 0 are counted as 0).
+     */
+    void add(double x) {
+        total++;
+        if (x <= 0) {
+            zeros++;
+            return;
+        }
+        counts[bucketOf(x)]++;
+    }
+
+    /**
+     * Combines another histogram into this one.
+     * @param other The histogram to combine.
+     */
+    void merge(const QuantileHistogram& other) {
+        for (size_t i = 0; i < counts.size(); i++)
+            counts[i] += other.counts[i];
+        total += other.total;
+        zeros += other.zeros;
+    }
+
+    /**
+     * Forgets every value recorded so far.
+     */
+    void reset() {
+        counts.assign(counts.size(), 0);
+        total = 0;
+        zeros = 0;
+    }
+
+    /**
+     * Returns the number of values recorded.
+     * @return The number of values recorded.
+     */
+    uint64_t getCount() const { return this->total; }
+
+    /**
+     * Estimates a quantile of the recorded values.
+     * @param q The quantile to estimate, between 0 and 1 (e.g. 0.99 for the 99th percentile).
+     * @return The midpoint of the bucket holding the quantile, or 0 if nothing was recorded.
+     */
+    double quantile(double q) const {
+        if (total == 0) return 0;
+
+        // Rank (1-based) of the value at the quantile
+        uint64_t rank = (uint64_t) std::ceil(q * total);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t seen = zeros;
+        if (seen >= rank) return 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) return midpointOf(i);
+        }
+        return midpointOf(counts.size() - 1);
+    }
+
+    /**
+     * Writes the histogram to a checkpoint, as its non-empty buckets only (most of them are empty).
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        vector<uint32_t> used;
+        for (size_t i = 0; i < counts.size(); i++)
+            if (counts[i] != 0) used.push_back((uint32_t) i);
+        out.put(total);
+        out.put(zeros);
+        out.putVector(used);
+        for (uint32_t i : used)
+            out.put(counts[i]);
+    }
+
+    /**
+     * Reads the histogram back from a checkpoint, replacing its contents.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint is inconsistent.
+     */
+    void load(CheckpointReader& in) {
+        reset();
+        total = in.get<uint64_t>();
+        zeros = in.get<uint64_t>();
+        vector<uint32_t> used;
+        in.getVector(used);
+        for (uint32_t i : used) {
+            if (i >= counts.size()) in.fail();
+            counts[i] = in.get<uint64_t>();
+        }
+    }
+
+private:
+    // Powers of two from 2^MIN_EXPONENT up to 2^(MIN_EXPONENT + NUM_EXPONENTS) are tracked (about 1e-12 to 1e12);
+    // values outside that range are clamped into the first or last bucket
+    static const int MIN_EXPONENT = -40;
+    static const int NUM_EXPONENTS = 80;
+    static const int SUB_BUCKETS = 128;
+
+    vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t zeros;
+
+    /**
+     * Finds the bucket a positive value falls in.
+     * @param x The value.
+     * @return The index of the value's bucket.
+     */
+    static size_t bucketOf(double x) {
+        int exponent;
+        double mantissa = std::frexp(x, &exponent); // x = mantissa * 2^exponent, mantissa in [0.5, 1)
+        int e = exponent - MIN_EXPONENT;
+        if (e < 0) return 0;
+        if (e >= NUM_EXPONENTS) return (size_t) NUM_EXPONENTS * SUB_BUCKETS - 1;
+        int sub = (int) ((mantissa - 0.5) * 2 * SUB_BUCKETS);
+        return (size_t) e * SUB_BUCKETS + sub;
+    }
+
+    /**
+     * Returns the value in the middle of a bucket.
+     * @param i The index of the bucket.
+     * @return The midpoint of the bucket.
+     */
+    static double midpointOf(size_t i) {
+        int e = (int) (i / SUB_BUCKETS);
+        int sub = (int) (i % SUB_BUCKETS);
+        double mantissa = 0.5 + (sub + 0.5) / (2.0 * SUB_BUCKETS);
+        return std::ldexp(mantissa, e + MIN_EXPONENT);
+    }
+
+};
+
+/**
+ * Computes the exact time-average of a piecewise constant quantity (such as the length of a queue), by integrating
+ * the quantity over time every time it changes rather than sampling it.
+ */
+class TimeWeightedAverage {
+
+public:
+
+    /**
+     * Creates a TimeWeightedAverage of a quantity that is 0 from the given time on.
+     * @param startTime The time (in seconds) to start averaging from.
+     */
+    explicit TimeWeightedAverage(double startTime = 0) {
+        this->current = 0;
+        reset(startTime);
+    }
+
+    /**
+     * Records that the quantity changed (or may have changed) to a new value.
+     * @param time The time (in seconds) of the change, no earlier than the last change.
+     * @param value The value of the quantity from this time on.
+     */
+    void update(double time, double value) {
+        integral += current * (time - lastTime);
+        lastTime = time;
+        current = value;
+    }
+
+    /**
+     * Restarts the average from the given time, keeping the current value of the quantity.
+     * @param startTime The time (in seconds) to start averaging from.
+     */
+    void reset(double startTime) {
+        this->startTime = startTime;
+        this->lastTime = startTime;
+        this->integral = 0;
+    }
+
+    /**
+     * Returns the integral of the quantity over time from the start time up to a given time.
+     * @param time The time (in seconds) to integrate up to, no earlier than the last change.
+     * @return The integral of the quantity (in value-seconds).
+     */
+    double getIntegral(double time) const {
+        return integral + current * (time - lastTime);
+    }
+
+    /**
+     * Returns the time the average starts from.
+     * @return The start time (in seconds).
+     */
+    double getStartTime() const { return this->startTime; }
+
+    /**
+     * Returns the time-average of the quantity from the start time up to a given time.
+     * @param time The time (in seconds) to average up to, no earlier than the last change.
+     * @return The time-average of the quantity, or its current value if no time has passed.
+     */
+    double getAverage(double time) const {
+        double elapsed = time - startTime;
+        if (elapsed <= 0) return current;
+        return (integral + current * (time - lastTime)) / elapsed;
+    }
+
+private:
+    double startTime;
+    double lastTime;
+    double current;
+    double integral;
+
+};
+
+/**
+ * Detects the end of the warm-up (initial transient) of a stream of observations with the MSER-5 rule: the
+ * observations are averaged in batches of 5, and the warm-up is the number of batches d that minimizes the marginal
+ * standard error of the batches after it,
+ *     MSER(d) = sum over i >= d of (Y_i - mean of Y after d)^2 / (n - d)^2,
+ * searched over the first half of the batches. A minimum at the end of that half means the stream hasn't settled yet
+ * (the last few batches are never considered, since their MSER is meaninglessly small by chance). The rule is checked
+ * every time the number of batches doubles, so checking costs O(1) amortized per observation, and the warm-up is
+ * declared over at the first check that finds it over. Since that is at most twice the detected warm-up, deleting
+ * everything observed up to then deletes the whole transient. A stream that never settles (such as an overloaded
+ * system's) would keep every batch forever, so the detector gives up once the check at MAX_BATCHES batches fails.
+ */
+class WarmupDetector {
+
+public:
+
+    // The number of observations averaged into each batch, and the number of batches at the first check
+    static const int BATCH_SIZE = 5;
+    static const size_t FIRST_CHECK = 20;
+    // The number of batches at the last check (10 MiB of batches, about 6.5 million observations)
+    static const size_t MAX_BATCHES = FIRST_CHECK << 16;
+
+    WarmupDetector() {
+        this->batchSum = 0;
+        this->batchCount = 0;
+        this->nextCheck = FIRST_CHECK;
+    }
+
+    /**
+     * Adds an observation. Once the detector has given up, observations are ignored.
+     * @param x The observation.
+     * @return True if the warm-up was found to be over (only returned once a check finds it over).
+     */
+    bool add(double x) {
+        if (hasGivenUp())
+            return false;
+        batchSum += x;
+        if (++batchCount < BATCH_SIZE)
+            return false;
+        batches.push_back(batchSum / BATCH_SIZE);
+        batchSum = 0;
+        batchCount = 0;
+
+        if (batches.size() < nextCheck)
+            return false;
+        nextCheck *= 2;
+        if (truncationPoint() < batches.size() / 2)
+            return true;
+        // Give up after the last check, freeing the batches
+        if (hasGivenUp())
+            vector<double>().swap(batches);
+        return false;
+    }
+
+    /**
+     * Returns whether the detector has given up finding the end of the warm-up, because the last check found it wasn't
+     * over.
+     * @return True if the detector has given up.
+     */
+    bool hasGivenUp() const { return nextCheck > MAX_BATCHES; }
+
+    /**
+     * Calculates the MSER-5 truncation point of the batches so far.
+     * @return The number of batches d (up to half of them) that minimizes MSER(d).
+     */
+    size_t truncationPoint() const {
+        // Suffix sums of the batches and of their squares, from the last batch back
+        size_t n = batches.size();
+        double sum = 0, sumSquares = 0, best = INFINITY;
+        size_t bestD = 0;
+        for (size_t d = n; d-- > 0;) {
+            sum += batches[d];
+            sumSquares += batches[d] * batches[d];
+            double count = (double) (n - d);
+            if (d > n / 2)
+                continue;
+            double mser = (sumSquares - sum * sum / count) / (count * count);
+            if (mser <= best) {
+                best = mser;
+                bestD = d;
+            }
+        }
+        return bestD;
+    }
+
+    /**
+     * Returns the number of observations added.
+     * @return The number of observations.
+     */
+    size_t getCount() const { return batches.size() * BATCH_SIZE + batchCount; }
+
+    /**
+     * Writes the detector's observations to a checkpoint.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        out.putVector(batches);
+        out.put(batchSum);
+        out.put(batchCount);
+        out.put((uint64_t) nextCheck);
+    }
+
+    /**
+     * Reads the detector's observations back from a checkpoint, replacing its own.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint is inconsistent.
+     */
+    void load(CheckpointReader& in) {
+        in.getVector(batches);
+        batchSum = in.get<double>();
+        batchCount = in.get<int>();
+        nextCheck = (size_t) in.get<uint64_t>();
+    }
+
+private:
+    vector<double> batches;
+    double batchSum;
+    int batchCount;
+    size_t nextCheck;
+
+};
+
+
+#endif //CS4328_PROJECT1_STREAMINGSTATISTICS_H
@@ -0,0 +1,181 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_THREADPOOL_H
+#define CS4328_PROJECT1_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::atomic;
+using std::condition_variable;
+using std::deque;
+using std::function;
+using std::lock_guard;
+using std::mutex;
+using std::thread;
+using std::unique_lock;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * A fixed-size pool of threads that run tasks with work stealing. Each worker has its own queue of tasks; it runs the
+ * newest task from its own queue and, when that runs dry, steals the oldest task from another worker's queue. This
+ * keeps all the threads busy even when tasks take very different amounts of time (as simulations near saturation do).
+ */
+class ThreadPool {
+
+public:
+
+    /**
+     * Creates a ThreadPool and starts its threads.
+     * @param numThreads The number of threads (0 to use one per hardware thread).
+     */
+    explicit ThreadPool(unsigned numThreads = 0) {
+        if (numThreads == 0) numThreads = thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1;
+
+        this->queued = 0;
+        this->unfinished = 0;
+        this->nextWorker = 0;
+        this->stopping = false;
+
+        for (unsigned i = 0; i < numThreads; i++)
+            workers.emplace_back(new Worker());
+        for (unsigned i = 0; i < numThreads; i++)
+            threads.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    /**
+     * Waits for all submitted tasks to finish and stops the threads.
+     */
+    ~ThreadPool() {
+        wait();
+        {
+            lock_guard<mutex> lock(idleLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads)
+            t.join();
+    }
+
+    /**
+     * Returns the number of threads in the pool.
+     * @return The number of threads.
+     */
+    unsigned size() { return (unsigned) threads.size(); }
+
+    /**
+     * Submits a task to be run by one of the threads. Tasks are spread over the workers' queues in turn.
+     * @param task The task to run.
+     */
+    void submit(function<void()> task) {
+        Worker& worker = *workers[nextWorker++ % workers.size()];
+        unfinished++;
+        {
+            lock_guard<mutex> lock(worker.lock);
+            worker.tasks.push_back(std::move(task));
+        }
+        {
+            lock_guard<mutex> lock(idleLock);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * Blocks until every submitted task has finished.
+     */
+    void wait() {
+        unique_lock<mutex> lock(idleLock);
+        finished.wait(lock, [this] { return unfinished == 0; });
+    }
+
+private:
+    /**
+     * A worker's queue of tasks.
+     */
+    struct Worker {
+        deque<function<void()>> tasks;
+        mutex lock;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    atomic<unsigned> nextWorker;
+
+    // Number of tasks waiting in queues (guarded by idleLock) and number of tasks submitted but not finished
+    unsigned long queued;
+    atomic<unsigned long> unfinished;
+    bool stopping;
+    mutex idleLock;
+    condition_variable wake;
+    condition_variable finished;
+
+    /**
+     * Takes a task, first from the back of the worker's own queue, then from the front of the others'.
+     * @param self The index of the worker looking for a task.
+     * @param task Set to the task taken.
+     * @return True if a task was taken, false if every queue was empty.
+     */
+    bool take(unsigned self, function<void()>& task) {
+        {
+            Worker& own = *workers[self];
+            lock_guard<mutex> lock(own.lock);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < workers.size(); i++) {
+            Worker& victim = *workers[(self + i) % workers.size()];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * The loop each thread runs: take and run tasks, sleeping while there are none.
+     * @param self The index of the thread's worker.
+     */
+    void run(unsigned self) {
+        while (true) {
+            {
+                unique_lock<mutex> lock(idleLock);
+                wake.wait(lock, [this] { return stopping || queued > 0; });
+                if (queued == 0) return;
+                queued--;
+            }
+
+            // A task is reserved for this thread, so keep looking until it is found in some queue
+            function<void()> task;
+            while (!take(self, task))
+                std::this_thread::yield();
+            task();
+
+            if (--unfinished == 0) {
+                lock_guard<mutex> lock(idleLock);
+                finished.notify_all();
+            }
+        }
+    }
+
+};
+
+
+#endif //CS4328_PROJECT1_THREADPOOL_H
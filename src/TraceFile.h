@@ -0,0 +1,213 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_TRACEFILE_H
+#define CS4328_PROJECT1_TRACEFILE_H
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::ifstream;
+using std::ofstream;
+using std::runtime_error;
+using std::string;
+
+/**
+ * One process of a workload trace: when it arrives and how long it needs the CPU.
+ */
+struct TraceRecord {
+    double arrivalTime;
+    double serviceTime;
+};
+
+/**
+ * The header at the start of a binary trace file. It is followed directly by `count` TraceRecords, in order of
+ * arrival time. All values are stored in the machine's native byte order.
+ */
+struct TraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+};
+
+const char TRACE_MAGIC[8] {'S', 'C', 'H', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t TRACE_VERSION = 1;
+
+/**
+ * A read-only, memory-mapped binary trace file. The records are read straight out of the mapping, so nothing is copied
+ * and only the pages being read need to be in memory: pages that have been read can be handed back to the kernel with
+ * release() so even traces far larger than memory can be replayed.
+ */
+class TraceFile {
+
+public:
+
+    /**
+     * Maps a binary trace file into memory.
+     * @param path The path of the trace file.
+     * @throws runtime_error If the file can't be opened or isn't a valid trace.
+     */
+    explicit TraceFile(const string& path) {
+        this->mapping = nullptr;
+        this->length = 0;
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw runtime_error("Can't open trace \"" + path + "\": " + strerror(errno));
+        struct stat st {};
+        if (fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(TraceHeader)) {
+            close(fd);
+            throw runtime_error("\"" + path + "\" is not a trace file");
+        }
+
+        this->length = (size_t) st.st_size;
+        void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED)
+            throw runtime_error("Can't map trace \"" + path + "\": " + strerror(errno));
+        this->mapping = static_cast<char*>(m);
+
+        const TraceHeader* header = reinterpret_cast<const TraceHeader*>(mapping);
+        if (memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || header->version != TRACE_VERSION
+            || header->recordSize != sizeof(TraceRecord)
+            || header->count > (length - sizeof(TraceHeader)) / sizeof(TraceRecord)) {
+            munmap(mapping, length);
+            throw runtime_error("\"" + path + "\" is not a valid trace file");
+        }
+
+        this->records = reinterpret_cast<const TraceRecord*>(mapping + sizeof(TraceHeader));
+        this->count = header->count;
+        // The records are read front to back, so let the kernel read ahead aggressively
+        madvise(mapping, length, MADV_SEQUENTIAL);
+    }
+
+    TraceFile(const TraceFile&) = delete;
+    TraceFile& operator=(const TraceFile&) = delete;
+
+    /**
+     * Unmaps the trace file.
+     */
+    ~TraceFile() {
+        if (mapping != nullptr)
+            munmap(mapping, length);
+    }
+
+    /**
+     * Returns the number of records in the trace.
+     * @return The number of records.
+     */
+    size_t size() const { return this->count; }
+
+    const TraceRecord* begin() const { return this->records; }
+    const TraceRecord* end() const { return this->records + this->count; }
+
+    /**
+     * Tells the kernel the records before a point won't be read again, so their pages can be dropped from memory.
+     * @param upTo The first record that may still be read.
+     */
+    void release(const TraceRecord* upTo) {
+        // Only whole pages before upTo can be released
+        size_t page = (size_t) sysconf(_SC_PAGESIZE);
+        size_t bytes = (size_t) (reinterpret_cast<const char*>(upTo) - mapping) / page * page;
+        if (bytes > 0)
+            madvise(mapping, bytes, MADV_DONTNEED);
+    }
+
+    /**
+     * Converts a text trace to a binary trace file. Each line of the text trace holds a process' arrival time and
+     * service time (in seconds), separated by a comma or whitespace. Blank lines, lines starting with '#' and a header
+     * (the first line that isn't either) are skipped. The text is streamed, so traces of any length can be converted.
+     * @param csvPath The path of the text trace.
+     * @param tracePath The path of the binary trace file to write.
+     * @return The number of records written.
+     * @throws runtime_error If a file can't be opened, a line can't be parsed, or its times aren't finite, arrival
+     * times are negative or decrease, or service times aren't positive.
+     */
+    static size_t importCsv(const string& csvPath, const string& tracePath) {
+        ifstream in(csvPath);
+        if (!in)
+            throw runtime_error("Can't open \"" + csvPath + "\"");
+        ofstream out(tracePath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw runtime_error("Can't create \"" + tracePath + "\"");
+
+        // Write a placeholder header, then fill in the count once all the records are written
+        TraceHeader header {};
+        memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        header.version = TRACE_VERSION;
+        header.recordSize = sizeof(TraceRecord);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        string line;
+        unsigned long lineNumber = 0;
+        bool headerAllowed = true;
+        double lastArrival = 0;
+        while (getline(in, line)) {
+            lineNumber++;
+            const char* s = line.c_str();
+            while (*s == ' ' || *s == '\t') s++;
+            if (*s == '\0' || *s == '\r' || *s == '#') continue;
+
+            char* end;
+            TraceRecord r {};
+            r.arrivalTime = strtod(s, &end);
+            bool parsed = end != s;
+            s = end;
+            while (*s == ',' || *s == ' ' || *s == '\t') s++;
+            r.serviceTime = strtod(s, &end);
+            parsed = parsed && end != s;
+            // Nothing but whitespace may follow the service time
+            for (s = end; *s == ' ' || *s == '\t' || *s == '\r'; s++);
+            parsed = parsed && *s == '\0';
+
+            if (!parsed) {
+                // Allow a header on the first line
+                if (headerAllowed) {
+                    headerAllowed = false;
+                    continue;
+                }
+                throw runtime_error(csvPath + ":" + std::to_string(lineNumber) + ": expected \"<arrival>,<service>\"");
+            }
+            headerAllowed = false;
+            if (!std::isfinite(r.arrivalTime) || !std::isfinite(r.serviceTime) || r.arrivalTime < lastArrival
+                || r.serviceTime <= 0)
+                throw runtime_error(csvPath + ":" + std::to_string(lineNumber)
+                                    + ": times must be finite, arrival times must be at least 0 and not decrease, and "
+                                      "service times must be positive");
+
+            lastArrival = r.arrivalTime;
+            out.write(reinterpret_cast<const char*>(&r), sizeof(r));
+            header.count++;
+        }
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!out)
+            throw runtime_error("Error writing \"" + tracePath + "\"");
+        return header.count;
+    }
+
+private:
+    char* mapping;
+    size_t length;
+    const TraceRecord* records;
+    size_t count;
+
+};
+
+
+#endif //CS4328_PROJECT1_TRACEFILE_H
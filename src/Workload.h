@@ -0,0 +1,342 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_WORKLOAD_H
+#define CS4328_PROJECT1_WORKLOAD_H
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "RandomStream.h"
+#include "TraceFile.h"
+
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+/*
+ * A workload is the source of the processes a simulation runs. Every workload provides
+ *   bool next(double& interArrivalTime, double& serviceTime)
+ * which gives the time (in seconds) from the previous process' arrival to the next one's, and the next process'
+ * service time, or returns false once the workload has no more processes. The inter-arrival time of the first process
+ * is ignored, since it arrives at time 0. Simulations are templated on the workload so the call is resolved at compile
+ * time.
+ */
+
+/**
+ * A workload of processes with exponentially distributed inter-arrival and service times (a poisson process), drawn
+ * from a random stream. It never runs out.
+ */
+class SyntheticWorkload {
+
+public:
+
+    /**
+     * Creates a SyntheticWorkload drawing from the given stream.
+     * @param rng The stream to draw random numbers from.
+     * @param arrivalRate The average arrival rate (in processes/second).
+     * @param serviceTime The average service time (in seconds).
+     */
+    SyntheticWorkload(RandomStream& rng, double arrivalRate, double serviceTime)
+            : variates(rng, arrivalRate, serviceTime) {}
+
+    /**
+     * Draws the next process.
+     * @param interArrivalTime Set to the time (in seconds) between the previous arrival and the next.
+     * @param serviceTime Set to the service time (in seconds) of the next process.
+     * @return True, always.
+     */
+    bool next(double& interArrivalTime, double& serviceTime) {
+        variates.next(interArrivalTime, serviceTime);
+        return true;
+    }
+
+    /**
+     * Writes where the workload is to a checkpoint.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const { variates.save(out); }
+
+    /**
+     * Moves the workload to where a checkpoint left it.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint is of another workload, or inconsistent.
+     */
+    void load(CheckpointReader& in) { variates.load(in); }
+
+private:
+    // Inter-arrival and service times are generated in batches
+    VariateBuffer variates;
+
+};
+
+/**
+ * The processes of a SyntheticWorkload generated once, up front, so simulations of different schedulers (on different
+ * threads) can all read the very same processes from shared, read-only memory: common random numbers. Only the first
+ * processes are stored, along with the state the random stream is left in after them, so a simulation that needs more
+ * goes on drawing exactly the processes a SyntheticWorkload on the same stream would.
+ */
+class CommonWorkload {
+
+public:
+
+    /**
+     * Generates the first processes of a SyntheticWorkload drawing from the given random stream.
+     * @param seed The seed of the workload's random stream.
+     * @param stream Which of the seed's streams to draw from.
+     * @param arrivalRate The average arrival rate (in processes/second).
+     * @param serviceTime The average service time (in seconds).
+     * @param count The number of processes to store (rounded up to whole batches of the VariateBuffer).
+     */
+    CommonWorkload(unsigned long seed, unsigned long stream, double arrivalRate, double serviceTime, size_t count)
+            : rng(seed, stream) {
+        this->arrivalRate = arrivalRate;
+        this->serviceTime = serviceTime;
+
+        // Generate whole batches so the stream is left where the next batch would start
+        size_t batches = (count + VariateBuffer::DEFAULT_BATCH_SIZE - 1) / VariateBuffer::DEFAULT_BATCH_SIZE;
+        interArrivalTimes.resize(batches * VariateBuffer::DEFAULT_BATCH_SIZE);
+        serviceTimes.resize(interArrivalTimes.size());
+        VariateBuffer variates(rng, arrivalRate, serviceTime);
+        for (size_t i = 0; i < interArrivalTimes.size(); i++)
+            variates.next(interArrivalTimes[i], serviceTimes[i]);
+    }
+
+    /**
+     * Returns the number of processes stored.
+     * @return The number of processes.
+     */
+    size_t size() const { return interArrivalTimes.size(); }
+
+    /**
+     * Returns the time between a stored process' arrival and the one before it.
+     * @param i The index of the process.
+     * @return The inter-arrival time (in seconds).
+     */
+    double getInterArrivalTime(size_t i) const { return interArrivalTimes[i]; }
+
+    /**
+     * Returns the service time of a stored process.
+     * @param i The index of the process.
+     * @return The service time (in seconds).
+     */
+    double getServiceTime(size_t i) const { return serviceTimes[i]; }
+
+    /**
+     * Returns the average arrival rate the workload was generated with.
+     * @return The arrival rate (in processes/second).
+     */
+    double getArrivalRate() const { return arrivalRate; }
+
+    /**
+     * Returns the average service time the workload was generated with.
+     * @return The average service time (in seconds).
+     */
+    double getAverageServiceTime() const { return serviceTime; }
+
+    /**
+     * Returns the random stream as it was left after generating the stored processes.
+     * @return The stream to continue the workload from.
+     */
+    const RandomStream& getStream() const { return rng; }
+
+private:
+    RandomStream rng;
+    double arrivalRate;
+    double serviceTime;
+
+    vector<double> interArrivalTimes;
+    vector<double> serviceTimes;
+
+};
+
+/**
+ * A workload reading the processes of a CommonWorkload in order, then drawing more from its own copy of the stream
+ * they were generated from once it runs past them. Any number of readers can share one CommonWorkload.
+ */
+class CommonWorkloadReader {
+
+public:
+
+    /**
+     * Creates a CommonWorkloadReader starting at the first process.
+     * @param workload The shared processes, which must outlive the CommonWorkloadReader.
+     */
+    explicit CommonWorkloadReader(const CommonWorkload& workload)
+            : workload(workload), rng(workload.getStream()),
+              variates(rng, workload.getArrivalRate(), workload.getAverageServiceTime()) {
+        this->index = 0;
+    }
+
+    CommonWorkloadReader(const CommonWorkloadReader&) = delete;
+    CommonWorkloadReader& operator=(const CommonWorkloadReader&) = delete;
+
+    /**
+     * Reads the next process.
+     * @param interArrivalTime Set to the time (in seconds) between the previous arrival and the next.
+     * @param serviceTime Set to the service time (in seconds) of the next process.
+     * @return True, always.
+     */
+    bool next(double& interArrivalTime, double& serviceTime) {
+        if (index < workload.size()) {
+            interArrivalTime = workload.getInterArrivalTime(index);
+            serviceTime = workload.getServiceTime(index);
+            index++;
+            return true;
+        }
+        variates.next(interArrivalTime, serviceTime);
+        return true;
+    }
+
+    /**
+     * Writes where the reader is to a checkpoint.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        out.put((uint64_t) index);
+        variates.save(out);
+    }
+
+    /**
+     * Moves the reader to where a checkpoint left it.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint is of another workload, or inconsistent.
+     */
+    void load(CheckpointReader& in) {
+        index = (size_t) in.getCount(workload.size());
+        variates.load(in);
+    }
+
+private:
+    const CommonWorkload& workload;
+    size_t index;
+    // The continuation of the stream past the shared processes (rng must be declared before variates)
+    RandomStream rng;
+    VariateBuffer variates;
+
+};
+
+/**
+ * A workload replaying the processes recorded in a binary trace file, in order. Arrival times are taken relative to the
+ * first record's. The records are read in place from the memory-mapped trace, and pages already replayed are released
+ * every so often, so a trace of any length streams through a small, fixed amount of memory.
+ */
+class TraceWorkload {
+
+public:
+
+    /**
+     * Creates a TraceWorkload replaying a binary trace file.
+     * @param path The path of the trace file.
+     * @throws runtime_error If the file can't be opened or isn't a valid trace.
+     */
+    explicit TraceWorkload(const string& path) : trace(path) {
+        this->path = path;
+        this->cursor = trace.begin();
+        this->released = trace.begin();
+        this->lastArrival = trace.size() > 0 ? trace.begin()->arrivalTime : 0;
+    }
+
+    /**
+     * Reads the next process from the trace.
+     * @param interArrivalTime Set to the time (in seconds) between the previous arrival and the next.
+     * @param serviceTime Set to the service time (in seconds) of the next process.
+     * @return True if a process was read, false if the whole trace has been replayed.
+     * @throws runtime_error If the record's times aren't finite, its arrival time is before the previous record's, or
+     * its service time isn't positive (importCsv() never writes such records, but a trace may come from elsewhere).
+     */
+    bool next(double& interArrivalTime, double& serviceTime) {
+        if (cursor == trace.end()) return false;
+
+        if (!std::isfinite(cursor->arrivalTime) || !std::isfinite(cursor->serviceTime)
+            || cursor->arrivalTime < lastArrival || cursor->serviceTime <= 0)
+            throw runtime_error("Record " + std::to_string(cursor - trace.begin()) + " of trace \"" + path
+                                + "\" is invalid");
+
+        interArrivalTime = cursor->arrivalTime - lastArrival;
+        serviceTime = cursor->serviceTime;
+        lastArrival = cursor->arrivalTime;
+        cursor++;
+
+        if (cursor - released >= RELEASE_RECORDS) {
+            trace.release(cursor);
+            released = cursor;
+        }
+        return true;
+    }
+
+    /**
+     * Returns the number of processes in the trace.
+     * @return The number of processes.
+     */
+    size_t size() const { return trace.size(); }
+
+    /**
+     * Writes where the replay is to a checkpoint.
+     * @param out The checkpoint to write to.
+     */
+    void save(CheckpointWriter& out) const {
+        out.put((uint64_t) trace.size());
+        out.put((uint64_t) (cursor - trace.begin()));
+        out.put(lastArrival);
+    }
+
+    /**
+     * Moves the replay to where a checkpoint left it.
+     * @param in The checkpoint to read from.
+     * @throws runtime_error If the checkpoint replayed a trace of another size, or is inconsistent.
+     */
+    void load(CheckpointReader& in) {
+        if (in.get<uint64_t>() != trace.size())
+            throw runtime_error("The checkpoint replayed a different trace");
+        cursor = trace.begin() + in.getCount(trace.size());
+        lastArrival = in.get<double>();
+        trace.release(cursor);
+        released = cursor;
+    }
+
+private:
+    // The number of records (64 MiB) replayed between releasing their pages
+    static const long RELEASE_RECORDS = (64 << 20) / sizeof(TraceRecord);
+
+    string path;
+    TraceFile trace;
+    const TraceRecord* cursor;
+    const TraceRecord* released;
+    double lastArrival;
+
+};
+
+/**
+ * A workload with no processes of its own, for simulations whose processes all arrive from outside (see
+ * Simulation::injectArrival()).
+ */
+class ExternalWorkload {
+
+public:
+
+    /**
+     * Provides no process.
+     * @return False, always.
+     */
+    bool next(double&, double&) {
+        return false;
+    }
+
+    /**
+     * Writes nothing, since the processes come from outside.
+     */
+    void save(CheckpointWriter&) const {}
+
+    /**
+     * Reads nothing, since the processes come from outside.
+     */
+    void load(CheckpointReader&) {}
+
+};
+
+
+#endif //CS4328_PROJECT1_WORKLOAD_H
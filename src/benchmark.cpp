@@ -0,0 +1,588 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "Simulation.h"
+#include "ClusterSimulation.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::function;
+using std::ifstream;
+using std::ofstream;
+using std::string;
+using std::stod;
+using std::stoi;
+using std::stringstream;
+using std::unique_ptr;
+using std::vector;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+/**
+ * The result of one benchmark: how many operations (events, for whole simulations) it timed and how long they took.
+ */
+struct BenchmarkResult {
+    string name;
+    // "micro" for a single data structure, "macro" for a whole simulation
+    string kind;
+    unsigned long operations;
+    double seconds;
+    // Peak resident set size (in KiB) of the whole benchmark process so far
+    long peakRssKib;
+
+    double nsPerOperation() const { return seconds * 1e9 / operations; }
+    double operationsPerSecond() const { return operations / seconds; }
+};
+
+/**
+ * Options shared by every benchmark.
+ */
+struct BenchmarkOptions {
+    // How many times each benchmark is repeated (the fastest repetition counts)
+    int repetitions = 5;
+    // Operations per micro benchmark repetition
+    unsigned long operations = 1 << 20;
+    // Processes per macro benchmark
+    int processes = 200000;
+    EventQueueBackend backend = SET_QUEUE;
+    // Only benchmarks whose name contains this are run
+    string filter;
+};
+
+// Results are folded into this so the compiler can't optimize the benchmarked work away
+volatile double sink;
+
+/**
+ * Returns the peak resident set size of the process.
+ * @return The peak resident set size (in KiB).
+ */
+long peakRssKib() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Times a micro benchmark, keeping the fastest of several repetitions.
+ * @param options The benchmark options.
+ * @param name The name of the benchmark.
+ * @param setup Called before each repetition, untimed, to build the state the benchmark runs on.
+ * @param run Called once per repetition to perform options.operations operations.
+ * @param results The list to add the result to (if the benchmark isn't filtered out).
+ */
+void microBenchmark(const BenchmarkOptions& options, const string& name, const function<void()>& setup,
+                    const function<void()>& run, vector<BenchmarkResult>& results) {
+    if (name.find(options.filter) == string::npos) return;
+
+    double best = INFINITY;
+    for (int r = 0; r < options.repetitions; r++) {
+        setup();
+        auto start = steady_clock::now();
+        run();
+        best = std::min(best, duration<double>(steady_clock::now() - start).count());
+    }
+    results.push_back({name, "micro", options.operations, best, peakRssKib()});
+}
+
+/**
+ * Benchmarks one event queue implementation: the "hold" operation (get the next event and schedule one a random time
+ * later, keeping the queue at a constant size), and scheduling an event then cancelling it.
+ * @tparam EventQueueType The event queue implementation.
+ * @param options The benchmark options.
+ * @param name The name of the implementation.
+ * @param results The list to add the results to.
+ */
+template <class EventQueueType>
+void benchmarkEventQueue(const BenchmarkOptions& options, const string& name, vector<BenchmarkResult>& results) {
+    const size_t pending = 1024;
+    RandomStream rng(1);
+    vector<double> seconds(options.operations);
+    rng.fillExponential(1, seconds.data(), seconds.size());
+    vector<SimTime> delays(seconds.size());
+    std::transform(seconds.begin(), seconds.end(), delays.begin(), toServiceTime);
+
+    unique_ptr<EventQueueType> queue;
+    auto fill = [&] {
+        queue.reset(new EventQueueType());
+        for (size_t i = 0; i < pending; i++)
+            queue->scheduleEvent(delays[i], DEPARTURE, (unsigned) i);
+    };
+
+    microBenchmark(options, "event_queue/" + name + "/hold", fill, [&] {
+        double total = 0;
+        for (unsigned long i = 0; i < options.operations; i++) {
+            Event e = queue->getEvent();
+            total += e.getTime();
+            queue->scheduleEvent(e.getTime() + delays[i], e.getType(), e.getCore());
+        }
+        sink = total;
+    }, results);
+
+    microBenchmark(options, "event_queue/" + name + "/schedule_cancel", fill, [&] {
+        SimTime time = 0;
+        for (unsigned long i = 0; i < options.operations; i++) {
+            time += delays[i] / (SimTime) pending;
+            queue->cancelEvent(queue->scheduleEvent(time, DEPARTURE, 0));
+        }
+        sink = (double) queue->nextTime();
+    }, results);
+}
+
+/**
+ * Benchmarks a ready queue: adding a process then getting the front one (keeping the queue at a constant size), and,
+ * for dynamic priorities, updating wait times and re-sorting on their own.
+ * @tparam ReadyQueueType The ready queue implementation.
+ * @param options The benchmark options.
+ * @param name The name of the ready queue.
+ * @param dynamicPriority Whether to benchmark updating priorities too.
+ * @param results The list to add the results to.
+ */
+template <class ReadyQueueType>
+void benchmarkReadyQueue(const BenchmarkOptions& options, const string& name, bool dynamicPriority,
+                         vector<BenchmarkResult>& results) {
+    const size_t waiting = 64;
+    RandomStream rng(2);
+    vector<double> seconds(options.operations + waiting);
+    rng.fillExponential(1 / 0.06, seconds.data(), seconds.size());
+    vector<SimTime> serviceTimes(seconds.size());
+    std::transform(seconds.begin(), seconds.end(), serviceTimes.begin(), toServiceTime);
+    const SimTime interval = toSimTime(0.01);
+
+    unique_ptr<ProcessTable> processes;
+    unique_ptr<ReadyQueueType> queue;
+    auto fill = [&] {
+        queue.reset();
+        processes.reset(new ProcessTable());
+        queue.reset(new ReadyQueueType(*processes));
+        for (size_t i = 0; i < waiting; i++)
+            queue->add(processes->acquire((int) i, interval * (SimTime) i, serviceTimes[i]));
+    };
+
+    // With dynamic priorities, the simulation updates the priorities before every dequeue, so the benchmark does too.
+    // Updating re-orders every waiting process, so time fewer operations.
+    BenchmarkOptions dynamicOptions = options;
+    if (dynamicPriority)
+        dynamicOptions.operations = std::max(1ul, options.operations / waiting);
+
+    microBenchmark(dynamicOptions, "ready_queue/" + name + "/add_get_front", fill, [&] {
+        SimTime clock = interval * (SimTime) waiting;
+        for (unsigned long i = 0; i < dynamicOptions.operations; i++) {
+            queue->add(processes->acquire((int) (waiting + i), clock, serviceTimes[waiting + i]));
+            if (dynamicPriority) {
+                queue->updateWaitTimes(clock);
+                queue->sort();
+            }
+            processes->release(queue->getFront());
+            clock += interval;
+        }
+        sink = (double) clock;
+    }, results);
+
+    if (!dynamicPriority) return;
+
+    microBenchmark(dynamicOptions, "ready_queue/" + name + "/update_sort", fill, [&] {
+        SimTime clock = interval * (SimTime) waiting;
+        for (unsigned long i = 0; i < dynamicOptions.operations; i++) {
+            clock += interval;
+            queue->updateWaitTimes(clock);
+            queue->sort();
+        }
+        sink = (double) clock;
+    }, results);
+}
+
+/**
+ * Benchmarks generating random variates: single exponential draws, and inter-arrival/service time pairs handed out
+ * from a VariateBuffer.
+ * @param options The benchmark options.
+ * @param results The list to add the results to.
+ */
+void benchmarkVariates(const BenchmarkOptions& options, vector<BenchmarkResult>& results) {
+    RandomStream rng(3);
+    microBenchmark(options, "variates/exponential", [] {}, [&] {
+        double total = 0;
+        for (unsigned long i = 0; i < options.operations; i++)
+            total += rng.exponential(1);
+        sink = total;
+    }, results);
+
+    microBenchmark(options, "variates/buffered_pair", [] {}, [&] {
+        VariateBuffer variates(rng, 15, 0.06);
+        double total = 0, interArrivalTime, serviceTime;
+        for (unsigned long i = 0; i < options.operations; i++) {
+            variates.next(interArrivalTime, serviceTime);
+            total += interArrivalTime + serviceTime;
+        }
+        sink = total;
+    }, results);
+}
+
+/**
+ * Runs one scheduler at every benchmarked utilization, timing the whole simulation per event (the fastest of several
+ * repetitions counts).
+ * @tparam Policy The SchedulingPolicy of the scheduler.
+ * @tparam EventQueueType The event queue implementation.
+ * @param options The benchmark options.
+ * @param name The name of the scheduler.
+ * @param results The list to add the results to.
+ */
+template <class Policy, class EventQueueType>
+void benchmarkScheduler(const BenchmarkOptions& options, const string& name, vector<BenchmarkResult>& results) {
+    // Utilizations from light to overloaded, with the default service time of 0.06 seconds
+    const char* labels[] {"0.5", "0.9", "0.99", "1.2"};
+    double utilizations[] {0.5, 0.9, 0.99, 1.2};
+
+    for (int i = 0; i < 4; i++) {
+        string fullName = "simulation/" + name + "/rho_" + labels[i];
+        if (fullName.find(options.filter) == string::npos) continue;
+
+        SimulationConfig config;
+        config.numProcesses = options.processes;
+        config.arrivalRate = utilizations[i] / config.serviceTime;
+        config.quantumLength = 0.01;
+
+        // Every repetition simulates the same processes, so handles the same events
+        double best = INFINITY;
+        unsigned long events = 0;
+        for (int r = 0; r < options.repetitions; r++) {
+            RandomStream rng(4, RandomStream::streamId(0, (unsigned) i, 0));
+            SyntheticWorkload workload(rng, config.arrivalRate, config.serviceTime);
+            Simulation<Policy, EventQueueType> simulation(config, workload);
+            auto start = steady_clock::now();
+            Statistics s = simulation.run();
+            best = std::min(best, duration<double>(steady_clock::now() - start).count());
+            events = simulation.getEventsHandled();
+            sink = s.avgTurnaroundTime;
+        }
+
+        results.push_back({fullName, "macro", events, best, peakRssKib()});
+    }
+}
+
+/**
+ * Lists the statistics of a simulation that must match exactly: every scalar, the utilization of each core and the
+ * number of migrations.
+ * @param s The statistics.
+ * @return The (name, value) of every statistic.
+ */
+vector<std::pair<string, double>> comparableStatistics(Statistics s) {
+    vector<std::pair<string, double>> values;
+    s.forEachScalar([&](const char* name, double value) { values.push_back({name, value}); });
+    for (size_t c = 0; c < s.coreUtilization.size(); c++)
+        values.push_back({"Core " + std::to_string(c) + " Util", s.coreUtilization[c]});
+    values.push_back({"Migrations", (double) s.migrations});
+    return values;
+}
+
+/**
+ * Checks that the parallel engine reproduces the sequential one: every scheduler, on one core and on several, simulated
+ * as a single cluster with no dispatch delay must give exactly the statistics of a plain Simulation of the same
+ * processes.
+ * @param options The benchmark options (the number of processes, event queue and filter).
+ * @return The number of simulations whose statistics differed.
+ */
+int checkEngines(const BenchmarkOptions& options) {
+    const char* names[] {"fcfs", "srtf", "hrrn", "rr", "mlfq", "cfs"};
+    int mismatches = 0;
+    for (int scheduler = 1; scheduler <= 6; scheduler++) {
+        for (unsigned cores : {1u, 3u}) {
+            string name = string("check/") + names[scheduler - 1] + "/cores_" + std::to_string(cores);
+            if (name.find(options.filter) == string::npos) continue;
+
+            SimulationConfig config;
+            config.numProcesses = options.processes;
+            config.numCores = cores;
+            config.arrivalRate = 0.9 * cores / config.serviceTime;
+            config.quantumLength = 0.01;
+            ClusterConfig cluster;
+            cluster.numThreads = 1;
+            RandomStream sequentialRng(5, 0), clusterRng(5, 0);
+            auto sequential = comparableStatistics(simulate(options.backend, scheduler, config, sequentialRng));
+            auto clustered = comparableStatistics(simulateClusters(options.backend, scheduler, config, cluster,
+                                                                   clusterRng));
+
+            string differences;
+            for (size_t i = 0; i < sequential.size(); i++)
+                if (i >= clustered.size() || sequential[i].second != clustered[i].second)
+                    differences += (differences.empty() ? "" : ", ") + sequential[i].first;
+            if (sequential.size() != clustered.size() && differences.empty())
+                differences = "number of cores";
+            printf("%-42s %s\n", name.c_str(), differences.empty() ? "ok" : ("DIFFERS: " + differences).c_str());
+            if (!differences.empty())
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * Checks that processes arriving at the same time are all simulated: every scheduler, on one core and on several,
+ * replays a trace whose processes arrive in groups of 4 at the same time, as traces with coarse timestamps do, and
+ * every process must depart. The ready queues are ordered sets, so processes that compared equal used to be lost.
+ * @param options The benchmark options (the number of processes and filter).
+ * @return The number of simulations that lost processes, or -1 if the trace couldn't be written.
+ */
+int checkTies(const BenchmarkOptions& options) {
+    char csvPath[] = "/tmp/schedsim-ties-XXXXXX";
+    int fd = mkstemp(csvPath);
+    if (fd == -1)
+        return -1;
+    close(fd);
+    string tracePath = string(csvPath) + ".trace";
+    {
+        RandomStream rng(5, 1);
+        ofstream csv(csvPath);
+        double time = 0;
+        for (int i = 0; i < options.processes; i++) {
+            if (i % 4 == 0)
+                time += rng.exponential(0.9 / 0.06 / 4);
+            csv << time << ',' << rng.exponential(1 / 0.06) << '\n';
+        }
+    }
+    try {
+        TraceFile::importCsv(csvPath, tracePath);
+    } catch (const std::runtime_error& e) {
+        cerr << e.what() << endl;
+        unlink(csvPath);
+        return -1;
+    }
+
+    const char* names[] {"fcfs", "srtf", "hrrn", "rr", "mlfq", "cfs"};
+    int mismatches = 0;
+    for (int scheduler = 1; scheduler <= 6; scheduler++) {
+        for (unsigned cores : {1u, 3u}) {
+            string name = string("check/ties/") + names[scheduler - 1] + "/cores_" + std::to_string(cores);
+            if (name.find(options.filter) == string::npos) continue;
+
+            SimulationConfig config;
+            config.numProcesses = options.processes;
+            config.numCores = cores;
+            config.quantumLength = 0.01;
+            // Sampling the ready queue would keep a simulation that lost processes running forever
+            config.queryInterval = 0;
+            int simulated = visitPolicy(scheduler, [&](auto policy) {
+                TraceWorkload workload(tracePath);
+                Simulation<typename decltype(policy)::type, EventQueue, TraceWorkload> simulation(config, workload);
+                simulation.run();
+                return simulation.getProcessesSimulated();
+            });
+            bool ok = simulated == options.processes;
+            printf("%-42s %s\n", name.c_str(),
+                   ok ? "ok" : ("LOST " + std::to_string(options.processes - simulated) + " PROCESSES").c_str());
+            if (!ok)
+                mismatches++;
+        }
+    }
+    unlink(csvPath);
+    unlink(tracePath.c_str());
+    return mismatches;
+}
+
+/**
+ * Reads the ns/operation of every benchmark in a JSON file written by writeJson().
+ * @param path The path of the JSON file.
+ * @param baseline Set to the (name, ns/operation) pairs read.
+ * @return True if the file could be read, false otherwise.
+ */
+bool readBaseline(const string& path, vector<std::pair<string, double>>& baseline) {
+    ifstream in(path);
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    string json = buffer.str();
+
+    // Each benchmark is an object with its "name" first, followed (somewhere) by its "ns_per_op"
+    size_t position = 0;
+    while ((position = json.find("\"name\"", position)) != string::npos) {
+        size_t open = json.find('"', json.find(':', position) + 1);
+        size_t close = json.find('"', open + 1);
+        size_t value = json.find("\"ns_per_op\"", close);
+        if (open == string::npos || close == string::npos || value == string::npos) break;
+        baseline.push_back({json.substr(open + 1, close - open - 1),
+                            stod(json.substr(json.find(':', value) + 1))});
+        position = close;
+    }
+    return true;
+}
+
+/**
+ * Writes benchmark results as JSON.
+ * @param path The path of the file to write.
+ * @param options The options the benchmarks were run with.
+ * @param results The results.
+ * @param regressions Whether each result regressed against the baseline.
+ */
+void writeJson(const string& path, const BenchmarkOptions& options, const vector<BenchmarkResult>& results,
+               const vector<bool>& regressions) {
+    ofstream out(path);
+    out << "{\n  \"processes\": " << options.processes << ",\n  \"operations\": " << options.operations
+        << ",\n  \"repetitions\": " << options.repetitions << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        char line[512];
+        snprintf(line, sizeof(line),
+                 "    {\"name\": \"%s\", \"kind\": \"%s\", \"operations\": %lu, \"seconds\": %.6f, "
+                 "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"peak_rss_kib\": %ld, \"regression\": %s}%s\n",
+                 r.name.c_str(), r.kind.c_str(), r.operations, r.seconds, r.nsPerOperation(),
+                 r.operationsPerSecond(), r.peakRssKib, regressions[i] ? "true" : "false",
+                 i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * Runs the benchmark suite: micro benchmarks of the event queues, ready queues and random variates, then every
+ * scheduler simulated at utilizations of 0.5, 0.9, 0.99 and 1.2. Each result is printed in ns and operations (or
+ * events, for simulations) per second along with the peak RSS, and can be saved as JSON and compared against a
+ * baseline saved earlier.
+ *
+ * Options:
+ *   "--out <file>" writes the results as JSON.
+ *   "--baseline <file>" compares the results against JSON written earlier, flagging every benchmark that got more than
+ *   "--threshold <percent>" (10 by default) slower per operation. The exit status is 1 if any did.
+ *   "--filter <text>" only runs the benchmarks whose name contains the text.
+ *   "--processes <n>" sets the number of processes per simulation (200000 by default), "--operations <n>" the number
+ *   of operations per micro benchmark (1048576 by default) and "--repetitions <n>" how many times each benchmark is
+ *   repeated (5 by default, the fastest counts).
+ *   "--queue <set|heap|calendar>" picks the event queue implementation the simulations run on (set by default).
+ *   "--check" runs no benchmarks, and instead checks that one cluster with no dispatch delay gives exactly the
+ *   statistics of a plain simulation, for every scheduler (see checkEngines()), and that processes arriving at the
+ *   same time are all simulated (see checkTies()). The exit status is 1 if any check fails.
+ * Compile like the simulator: g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark
+ */
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    string outPath, baselinePath;
+    double threshold = 10;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            threshold = stod(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc)
+            options.processes = stoi(argv[++i]);
+        else if (strcmp(argv[i], "--operations") == 0 && i + 1 < argc)
+            options.operations = std::stoul(argv[++i]);
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            options.repetitions = stoi(argv[++i]);
+        else if (strcmp(argv[i], "--check") == 0)
+            check = true;
+        else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "set")
+                options.backend = SET_QUEUE;
+            else if (name == "heap")
+                options.backend = HEAP_QUEUE;
+            else if (name == "calendar")
+                options.backend = CALENDAR_QUEUE;
+            else {
+                cerr << "Invalid event queue \"" << name << "\". Available choices: set, heap, calendar" << endl;
+                return 1;
+            }
+        }
+        else {
+            cerr << "Usage: benchmark [--out <file>] [--baseline <file>] [--threshold <percent>] [--filter <text>] "
+                    "[--processes <n>] [--operations <n>] [--repetitions <n>] [--queue <set|heap|calendar>] "
+                    "[--check]" << endl;
+            return 1;
+        }
+    }
+    if (options.processes < 1 || options.operations < 1 || options.repetitions < 1) {
+        cerr << "The number of processes, operations and repetitions must be positive" << endl;
+        return 1;
+    }
+
+    if (check) {
+        int mismatches = checkEngines(options);
+        if (mismatches > 0)
+            cout << mismatches << " simulation(s) differ between the sequential and parallel engines" << endl;
+        int lost = checkTies(options);
+        if (lost < 0)
+            cout << "Can't write a trace to check ties with" << endl;
+        else if (lost > 0)
+            cout << lost << " simulation(s) lost processes arriving at the same time" << endl;
+        return mismatches > 0 || lost != 0 ? 1 : 0;
+    }
+
+    vector<BenchmarkResult> results;
+    benchmarkEventQueue<EventQueue>(options, "set", results);
+    benchmarkEventQueue<HeapEventQueue>(options, "heap", results);
+    benchmarkEventQueue<CalendarEventQueue>(options, "calendar", results);
+    benchmarkReadyQueue<ReadyQueue<FCFSPriorityComparator, ProcessTable>>(options, "fcfs", false, results);
+    benchmarkReadyQueue<ReadyQueue<SRTFPriorityComparator, ProcessTable>>(options, "srtf", false, results);
+    benchmarkReadyQueue<ReadyQueue<HRRNPriorityComparator, ProcessTable>>(options, "hrrn", true, results);
+    benchmarkReadyQueue<HRRNReadyQueue<HRRNPriorityComparator, ProcessTable>>(options, "hrrn_kinetic", true, results);
+    benchmarkVariates(options, results);
+    visitEventQueue(options.backend, [&](auto queue) {
+        typedef typename decltype(queue)::type EventQueueType;
+        benchmarkScheduler<FCFSPolicy, EventQueueType>(options, "fcfs", results);
+        benchmarkScheduler<SRTFPolicy, EventQueueType>(options, "srtf", results);
+        benchmarkScheduler<HRRNPolicy, EventQueueType>(options, "hrrn", results);
+        benchmarkScheduler<RRPolicy, EventQueueType>(options, "rr", results);
+        benchmarkScheduler<MLFQPolicy, EventQueueType>(options, "mlfq", results);
+        benchmarkScheduler<CFSPolicy, EventQueueType>(options, "cfs", results);
+        return 0;
+    });
+
+    // Compare against the baseline, if given
+    vector<std::pair<string, double>> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        cerr << "Can't read baseline \"" << baselinePath << "\"" << endl;
+        return 1;
+    }
+    vector<bool> regressions(results.size(), false);
+    int numRegressions = 0;
+
+    printf("%-42s %12s %14s %10s %12s\n", "benchmark", "ns/op", "ops/s", "rss (MiB)", "vs baseline");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        string comparison;
+        for (auto& b : baseline) {
+            if (b.first != r.name) continue;
+            double change = 100 * (r.nsPerOperation() / b.second - 1);
+            char text[32];
+            snprintf(text, sizeof(text), "%+.1f%%", change);
+            comparison = text;
+            if (change > threshold) {
+                regressions[i] = true;
+                numRegressions++;
+                comparison += " REGRESSION";
+            }
+        }
+        printf("%-42s %12.2f %14.0f %10.1f %12s\n", r.name.c_str(), r.nsPerOperation(), r.operationsPerSecond(),
+               r.peakRssKib / 1024.0, comparison.c_str());
+    }
+
+    if (!outPath.empty())
+        writeJson(outPath, options, results, regressions);
+
+    if (numRegressions > 0) {
+        cout << numRegressions << " benchmark(s) regressed by more than " << threshold << "%" << endl;
+        return 1;
+    }
+    return 0;
+}
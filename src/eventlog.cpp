@@ -0,0 +1,60 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "EventLog.h"
+
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+
+/**
+ * Exports an event log written by a simulation ("--event-log <file>") to CSV, one line per event:
+ *   time,process,core,event
+ * with the time in seconds, the core empty for arrivals, and the event one of arrival, dispatch, preemption or
+ * departure. Usage: eventlog <log_file> [<csv_file>] (the CSV goes to standard output unless a file is given).
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        cerr << "Usage: \"eventlog <log_file> [<csv_file>]\"" << endl;
+        return 1;
+    }
+
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (out == nullptr) {
+        cerr << "Can't create \"" << argv[2] << "\"" << endl;
+        return 1;
+    }
+
+    try {
+        EventLogReader reader(argv[1]);
+        double ticksPerSecond = reader.getTicksPerSecond();
+        vector<LogEntry> entries;
+        fprintf(out, "time,process,core,event\n");
+        while (reader.nextBlock(entries)) {
+            for (const LogEntry& e : entries) {
+                fprintf(out, "%.9f,%" PRId32 ",", (double) e.ticks / ticksPerSecond, e.process);
+                if (e.core >= 0)
+                    fprintf(out, "%" PRId32, e.core);
+                fprintf(out, ",%s\n", LOG_EVENT_NAMES[e.type]);
+            }
+        }
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    if ((argc == 3 ? fclose(out) : fflush(out)) != 0) {
+        cerr << "Error writing the CSV" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,402 +5,805 @@
 
 #include <iostream>
 #include <fstream>
-#include <random>
 #include <vector>
 #include <numeric>
-
-#include "EventQueue.h"
-#include "ReadyQueue.h"
-#include "PriorityComparator.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <climits>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+#include "JobServer.h"
+#include "ResultCache.h"
+#include "SchedulerSimulator.h"
+#include "ThreadPool.h"
 
 using std::cerr;
 using std::cout;
 using std::endl;
-using std::stoi;
-using std::stod;
 using std::to_string;
+using std::string;
 using std::ofstream;
-using std::random_device;
-using std::mt19937;
-using std::uniform_real_distribution;
 using std::vector;
 using std::iota;
+using std::atomic;
+using std::mutex;
+using std::unique_ptr;
+using std::lock_guard;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::runtime_error;
+using std::pair;
 
 /**
- * Simple structure to hold statistics about a scheduling algorithms performance.
+ * A scheduler configuration simulated over every arrival rate of a sweep, with its results saved to its own CSV file.
  */
-struct Statistics {
-    double avgTurnaroundTime;
-    double throughput;
-    double avgCpuUtil;
-    double avgReadyQueueSize;
-
-    /**
-     * Prints a string representation of the statistics.
-     */
-    void display() {
-        printf("Avg. Turnaround Time : %6.3f\n"
-               "          Throughput : %6.3f\n"
-               "       Avg. CPU Util : %6.3f\n"
-               " Avg. in Ready Queue : %6.3f\n",
-               this->avgTurnaroundTime, this->throughput, this->avgCpuUtil, this->avgReadyQueueSize
-        );
-    }
+struct SweepScheduler {
+    string name;
+    int scheduler;
+    double quantumLength;
+    // The index the scheduler's random streams are numbered by (see RandomStream::streamId()), fixed for each scheduler
+    // so adding one to the sweep doesn't change any other's results
+    unsigned stream;
+};
+
+/**
+ * A single simulation in a sweep, along with its results.
+ */
+struct SweepJob {
+    size_t schedulerIndex;
+    double arrivalRate;
+    // The random stream of the first replication (see RandomStream::streamId())
+    unsigned long stream;
+
+    // The statistics (averaged over the replications, if replicated), and the half-widths of their confidence
+    // intervals
+    Statistics statistics;
+    Statistics halfWidth;
+    unsigned replications;
+    double wallTime;
 };
 
 /**
- * Uses the inverse of the probability distribution function for a poisson distribution to translate a random
- * number [0,1] following a uniform distribution into a random number [0,1] following a poisson distribution.
- * In the context of schedulers, it generates inter-arrival times or service times following an average rate given.
- * @param rate The average rate of arrival or service.
- * @return A random number following a poisson distribution given the rate.
+ * Gets the values a sweep saves for a simulation, in the order of the CSV columns after the arrival rate.
+ * @param s The statistics of the simulation.
+ * @return The average turnaround time, throughput, average CPU utilization, average ready queue size, then the
+ * turnaround and waiting time quantiles.
  */
-double inversePoisson(double rate) {
-    // Setup random number generator
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_real_distribution<> dis(0, 1);
-
-    // Generate random number and find corresponding number according to poisson distribution
-    double y = dis(gen);
-    return -1 * log(1 - y) / rate;
+vector<double> csvValues(const Statistics& s) {
+    vector<double> values {s.avgTurnaroundTime, s.throughput, s.avgCpuUtil, s.avgReadyQueueSize};
+    for (double q : s.turnaroundTimeQuantiles)
+        values.push_back(q);
+    for (double q : s.waitingTimeQuantiles)
+        values.push_back(q);
+    return values;
 }
 
 /**
- * Simulates a priority based scheduling algorithm with various options.
- * @tparam PriorityComparator The comparator to use for determining process priority. Must implement operator() for
- *         determining process priorities.
- * @param numProcesses The number of processes to simulate.
- * @param arrivalRate The average arrival rate (in processes/second) of the processes.
- * @param serviceTime The average service time (in seconds) of the processes.
- * @param quantumLength The quantum length (in seconds) to use in a round robin simulation (<0 to not do round robin)
- * @param queryInterval The interval at which various statistics are updated. Lower numbers improve statistics accuracy
- *        but increase running time.
- * @param doPreemption Whether or not the simulation will do preemption.
- * @param dynamicPriority Whether or not the simulation will use a dynamic priority scheme.
- * @return A Statistics struct containing the average turnaround time of all processes simulated (in seconds),
- *         the throughput of the simulation (in processes/second), the average CPU utilization, and the average ready queue
- *         size.
+ * Computes the key a sweep caches a simulation's results under, from everything the results depend on: the seed and
+ * stream, the scheduler, the simulation's parameters, and how the simulation was replicated. The event queue
+ * implementation, lazy cancellation and the number of threads all give identical results, so they're left out.
+ * @param seed The seed of the simulation's random stream.
+ * @param stream The simulation's random stream (with common random numbers, that of the replication).
+ * @param scheduler The scheduler, numbered as on the command line.
+ * @param config The parameters of the simulation.
+ * @param replication How many replications of the simulation were run (unused with common random numbers, whose
+ * replications are cached one by one).
+ * @param commonRandomNumbers Whether the result is of one replication on common random numbers.
+ * @return The key.
  */
-template <class PriorityComparator>
-Statistics simulatePriorityBased(int numProcesses, double arrivalRate, double serviceTime, double quantumLength,
-                                 double queryInterval, bool doPreemption, bool dynamicPriority) {
-    // Create data structures to hold events and processes
-    EventQueue eventQueue;
-    ReadyQueue<PriorityComparator> readyQueue;
-    vector<Process*> processes;
-
-    // Pointer to the process currently using the CPU
-    Process* onCpu = nullptr;
-
-    double clock = 0;
-    bool cpuIdle = true;
-
-    // Schedule first process arrival
-    auto firstProcess = new Process(0, 0, inversePoisson(1 / serviceTime));
-    processes.push_back(firstProcess);
-    eventQueue.scheduleEvent(clock, firstProcess, ARRIVAL);
-
-    // Schedule first timeout event for round robin (if quantumLength isn't negative or 0)
-    if (quantumLength > 0)
-        eventQueue.scheduleEvent(clock + quantumLength, nullptr, TIMEOUT);
-
-    // Schedule first query event
-    eventQueue.scheduleEvent(clock + queryInterval, nullptr, QUERY);
-
-    // Variables to hold statistics about simulation
-    int processesSimulated = 0;
-    double cpuIdleTime = 0;
-    double lastCpuBusyTime = 0;
-    int totalInReadyQueue = 0;
-
-    // Loop while need to simulate more processes
-    while (processesSimulated < numProcesses && !eventQueue.empty()) {
-
-        // Get next event and update clock
-        Event current = eventQueue.getEvent();
-        clock = current.getTime();
-
-        // If event is an arrival
-        if (current.getType() == ARRIVAL) {
-            // If CPU is idle
-            if (cpuIdle) {
-                // Set CPU to busy and update idle time
-                cpuIdle = false;
-                cpuIdleTime += clock - lastCpuBusyTime;
-                // Assign arriving process to CPU
-                current.getProcess()->setLastTimeAssignedCpu(clock);
-                onCpu = current.getProcess();
-                // Schedule arriving process' tentative departure (may be unscheduled later due to preemption or timeout)
-                eventQueue.scheduleEvent(clock + current.getProcess()->getServiceTimeLeft(), current.getProcess(), DEPARTURE);
-            }
-            // If CPU is busy
-            else {
-                // Add arriving process to the ready queue
-                readyQueue.add(current.getProcess());
-                // If dynamic priority scheme, update statistics and resort ready queue
-                if (dynamicPriority) {
-                    readyQueue.updateWaitTimes(clock);
-                    readyQueue.sort();
-                }
+uint64_t sweepKey(unsigned long seed, unsigned long stream, int scheduler, const SimulationConfig& config,
+                  const ReplicationConfig& replication, bool commonRandomNumbers) {
+    ResultKey key;
+    key.add((uint64_t) seed).add((uint64_t) stream).add((uint64_t) scheduler).add((uint64_t) config.numProcesses)
+       .add(config.arrivalRate).add(config.serviceTime).add(config.quantumLength).add(config.queryInterval)
+       .add((uint64_t) config.numCores).add((uint64_t) config.perCoreQueues).add((uint64_t) config.feedbackLevels)
+       .add(config.boostInterval).add(config.targetLatency).add((uint64_t) config.deleteWarmup)
+       .add((uint64_t) config.levelQuanta.size());
+    for (double quantum : config.levelQuanta)
+        key.add(quantum);
+    key.add((uint64_t) commonRandomNumbers);
+    if (!commonRandomNumbers && replication.enabled())
+        key.add((uint64_t) replication.minReplications).add((uint64_t) replication.maxReplications)
+           .add(replication.precision).add(replication.confidence);
+    return key.get();
+}
+
+/**
+ * A workload shared by every scheduler's simulation of one replication at one arrival rate. It is generated by the
+ * first simulation to start, and freed once the last one finishes.
+ */
+struct CommonWorkloadSlot {
+    std::once_flag generated;
+    unique_ptr<CommonWorkload> workload;
+    atomic<size_t> remaining;
+};
+
+/**
+ * Runs all the simulations specified in the assignment for different arrival rates and saves their statistics
+ * in a CSV file for easy importing into a spreadsheet for graph creation. The simulations are independent of each
+ * other, so they are run in parallel on a work-stealing thread pool. Each one gets its own random stream under the
+ * seed, numbered by its scheduler and arrival rate, so the results are the same no matter how many threads are used.
+ * The wall time of every simulation is saved in timings.csv. With more than one core, the arrival rates are scaled
+ * by the number of cores so each core sees the same range of loads as a single CPU would.
+ * If replicating, each job runs its own replications (stopping as soon as its target precision is reached, so the
+ * jobs near saturation take the most), and the CSV rows gain the number of replications and the lower and upper
+ * confidence bounds of every value.
+ * With common random numbers, every scheduler is instead simulated on the same processes at each arrival rate (those
+ * of the first scheduler's stream), generated once per replication and shared by the threads. The schedulers then
+ * differ only in how they schedule, so the difference of each from the first scheduler (FCFS) is measured far more
+ * precisely than independent runs would allow. Those paired differences and their confidence intervals are saved in
+ * one more CSV file per scheduler.
+ * With a result cache, only the simulations whose results aren't in it yet are run (with common random numbers, each
+ * replication is cached on its own, so adding a scheduler or replications only simulates what's new), and the CSV files
+ * are written from the cached and new results alike.
+ * @param seed The seed of the simulations' random streams.
+ * @param backend The event queue implementation to use.
+ * @param numThreads The number of threads to run simulations on (0 to use one per hardware thread).
+ * @param base The parameters shared by every simulation (the arrival rate and quantum length are set per job).
+ * @param replication How many replications of each simulation to run (with common random numbers, always the fewest,
+ * 10 if not given).
+ * @param commonRandomNumbers Whether to simulate every scheduler on the same processes.
+ * @param cache The cache to take results from and save new results to (nullptr to simulate everything).
+ * @throws runtime_error If the new results can't be saved to the cache.
+ */
+void runAllSimulations(unsigned long seed, EventQueueBackend backend, unsigned numThreads,
+                       const SimulationConfig& base, const ReplicationConfig& replication, bool commonRandomNumbers,
+                       ResultCache* cache) {
+
+    // Vector of average arrival rates to run simulations with (the service time is the default 0.06 seconds)
+    vector<double> arrivalRates (30);
+    iota(arrivalRates.begin(), arrivalRates.end(), 1);
+    for (auto& rate : arrivalRates)
+        rate *= base.numCores;
+
+    // Schedulers to simulate: First Come First Serve (FCFS), Shortest Remaining Time First (SRTF),
+    // Highest Response Ratio Next (HRRN), Round Robin (RR) with each quantum, then the multi-level feedback queue
+    // (MLFQ) and the Completely Fair Scheduler (CFS) with the shorter quantum. Round robin's streams are numbered after
+    // all the others, so another quantum can be added without changing the other schedulers' results.
+    double quantums[] {0.01, 0.2};
+    vector<SweepScheduler> schedulers {{"FCFS", 1, 0, 0}, {"SRTF", 2, 0, 1}, {"HRRN", 3, 0, 2}};
+    for (unsigned q = 0; q < sizeof(quantums) / sizeof(quantums[0]); q++)
+        schedulers.push_back({"RR(" + to_string(quantums[q]) + ")", 4, quantums[q], 5 + q});
+    schedulers.push_back({"MLFQ", 5, quantums[0], 3});
+    schedulers.push_back({"CFS", 6, quantums[0], 4});
+
+    // One job per scheduler and arrival rate, each with the stream numbered by its scheduler and arrival rate (or,
+    // with common random numbers, by its arrival rate alone)
+    vector<SweepJob> jobs;
+    for (size_t i = 0; i < schedulers.size(); i++)
+        for (size_t j = 0; j < arrivalRates.size(); j++)
+            jobs.push_back({i, arrivalRates[j],
+                            RandomStream::streamId(commonRandomNumbers ? 0 : schedulers[i].stream, (unsigned) j, 0),
+                            {}, {}, 1, 0});
+
+    bool replicated = replication.enabled() || commonRandomNumbers;
+    unsigned commonReplications = replication.minReplications > 1 ? replication.minReplications : 10;
+    // With common random numbers, the statistics and wall time of every job's replications, and the workload slot of
+    // every arrival rate's replications
+    vector<Statistics> replicationStatistics;
+    vector<double> replicationWallTimes;
+    vector<CommonWorkloadSlot> slots(commonRandomNumbers ? arrivalRates.size() * commonReplications : 0);
+    if (commonRandomNumbers) {
+        replicationStatistics.resize(jobs.size() * commonReplications);
+        replicationWallTimes.resize(jobs.size() * commonReplications);
+    }
 
-                // If doing preemption, update onCpu's statistics
-                if (doPreemption) {
-                    onCpu->setServiceTimeLeft(onCpu->getServiceTimeLeft() - (clock - onCpu->getLastTimeAssignedCpu()));
-
-                    Process* candidate = readyQueue.getFront();
-                    // Compare process currently on CPU with highest priority from the ready queue,
-                    // if front of ready queue has a higher priority, we switch to that process
-                    if (PriorityComparator()(candidate, onCpu)) {
-                        // Delete tentative departure of process on CPU
-                        eventQueue.unscheduleDeparture(onCpu->getId());
-                        // Move process from CPU to ready queue
-                        readyQueue.add(onCpu);
-                        // Assign arriving process to CPU
-                        onCpu = candidate;
-                        // Schedule tentative departure for new process
-                        eventQueue.scheduleEvent(clock + onCpu->getServiceTimeLeft(), onCpu, DEPARTURE);
-                    }
-                    // If front of ready queue is not higher priority
-                    else {
-                        // Place it back in the ready queue
-                        readyQueue.add(candidate);
-                    }
-                    // Whichever process is now using the CPU, update the last time it was assigned to now
-                    onCpu->setLastTimeAssignedCpu(clock);
+    // The parameters of a job's simulations
+    auto jobConfig = [&](const SweepJob& job) {
+        SimulationConfig config = base;
+        config.arrivalRate = job.arrivalRate;
+        config.quantumLength = schedulers[job.schedulerIndex].quantumLength;
+        return config;
+    };
+
+    // Take every result already in the cache, and simulate the rest: each job, or with common random numbers each
+    // replication of each job
+    size_t results = commonRandomNumbers ? replicationStatistics.size() : jobs.size();
+    vector<uint64_t> keys(cache != nullptr ? results : 0);
+    vector<bool> missing(results, true);
+    size_t cached = 0;
+    if (cache != nullptr) {
+        for (size_t k = 0; k < jobs.size(); k++) {
+            const SweepJob& job = jobs[k];
+            int scheduler = schedulers[job.schedulerIndex].scheduler;
+            SimulationConfig config = jobConfig(job);
+            for (unsigned r = 0; r < (commonRandomNumbers ? commonReplications : 1); r++) {
+                size_t n = commonRandomNumbers ? k * commonReplications + r : k;
+                keys[n] = sweepKey(seed, job.stream + r, scheduler, config, replication, commonRandomNumbers);
+                const CachedResult* result = cache->find(keys[n]);
+                if (result == nullptr) continue;
+                missing[n] = false;
+                cached++;
+                if (commonRandomNumbers) {
+                    replicationStatistics[n] = CachedResult::loadScalars(result->statistics);
+                    replicationWallTimes[n] = result->wallTime;
+                } else {
+                    jobs[k].statistics = CachedResult::loadScalars(result->statistics);
+                    jobs[k].halfWidth = CachedResult::loadScalars(result->halfWidths);
+                    jobs[k].replications = result->replications;
+                    jobs[k].wallTime = result->wallTime;
                 }
             }
-
-            // Schedule next process arrival
-            int nextId = current.getProcess()->getId() + 1;
-            double nextArrivalTime = clock + inversePoisson(arrivalRate);
-            auto nextArrival = new Process(nextId, nextArrivalTime, inversePoisson(1 / serviceTime));
-            processes.push_back(nextArrival);
-            eventQueue.scheduleEvent(nextArrivalTime, nextArrival, ARRIVAL);
         }
-        // If event is a departure
-        else if (current.getType() == DEPARTURE) {
-            // Increment number of processes simulated at each departure
-            processesSimulated++;
-            // Update completion time of departing process
-            current.getProcess()->setCompletionTime(clock);
-
-            // If ready queue is empty, set CPU to idle and update statistics
-            if (readyQueue.empty()) {
-                cpuIdle = true;
-                onCpu = nullptr;
-                lastCpuBusyTime = clock;
-            }
-            // If ready queue is not empty, put next process from ready queue on CPU and schedule its tentative departure
-            else {
-                // If dynamic priority scheme, update statistics and resort ready queue
-                if (dynamicPriority) {
-                    readyQueue.updateWaitTimes(clock);
-                    readyQueue.sort();
-                }
+    }
 
-                // Assign front of ready queue to CPU
-                Process* p = readyQueue.getFront();
-                p->setLastTimeAssignedCpu(clock);
-                onCpu = p;
-                eventQueue.scheduleEvent(clock + p->getServiceTimeLeft(), p, DEPARTURE);
+    // Run the jobs in parallel
+    ThreadPool pool(numThreads);
+    atomic<size_t> completed(0);
+    size_t tasks = results - cached;
+    mutex outputLock;
+    auto reportProgress = [&] {
+        size_t done = ++completed;
+        lock_guard<mutex> lock(outputLock);
+        cout << "\rSimulating on " << pool.size() << " threads..." << done << "/" << tasks << std::flush;
+    };
+    cout << "Simulating on " << pool.size() << " threads..." << std::flush;
+    if (commonRandomNumbers) {
+        // Submit replication by replication so each workload is freed soon after it's generated
+        for (unsigned r = 0; r < commonReplications; r++) {
+            for (size_t j = 0; j < arrivalRates.size(); j++) {
+                CommonWorkloadSlot& slot = slots[r * arrivalRates.size() + j];
+                slot.remaining = 0;
+                for (size_t i = 0; i < schedulers.size(); i++)
+                    slot.remaining += missing[(i * arrivalRates.size() + j) * commonReplications + r];
+                for (size_t i = 0; i < schedulers.size(); i++) {
+                    size_t k = i * arrivalRates.size() + j;
+                    if (!missing[k * commonReplications + r]) continue;
+                    pool.submit([&, r, k] {
+                        auto start = steady_clock::now();
+                        const SweepJob& job = jobs[k];
+                        SimulationConfig config = jobConfig(job);
+                        std::call_once(slot.generated, [&] {
+                            slot.workload.reset(new CommonWorkload(seed, job.stream + r, config.arrivalRate,
+                                                                   config.serviceTime,
+                                                                   (size_t) config.numProcesses + 1));
+                        });
+                        CommonWorkloadReader workload(*slot.workload);
+                        replicationStatistics[k * commonReplications + r] =
+                                simulateWorkload(backend, schedulers[job.schedulerIndex].scheduler, config, workload);
+                        if (--slot.remaining == 0)
+                            slot.workload.reset();
+                        replicationWallTimes[k * commonReplications + r] =
+                                duration<double>(steady_clock::now() - start).count();
+                        reportProgress();
+                    });
+                }
             }
         }
-        // If event is a timeout (round robin only)
-        else if (current.getType() == TIMEOUT) {
-            // If the CPU is idle, do nothing
-            if (cpuIdle);
-            // If CPU is busy, switch to process at the front of the ready queue
-            else {
-                // Update current process' remaining service time, unschedule tentative departure, and place in ready queue
-                onCpu->setServiceTimeLeft(onCpu->getServiceTimeLeft() - (clock - onCpu->getLastTimeAssignedCpu()));
-                eventQueue.unscheduleDeparture(onCpu->getId());
-                readyQueue.add(onCpu);
-
-                // If dynamic priority scheme, update statistics and resort ready queue
-                if (dynamicPriority) {
-                    readyQueue.updateWaitTimes(clock);
-                    readyQueue.sort();
+    } else {
+        for (size_t k = 0; k < jobs.size(); k++) {
+            if (!missing[k]) continue;
+            pool.submit([&, k] {
+                auto start = steady_clock::now();
+                SweepJob& job = jobs[k];
+                const SweepScheduler& sched = schedulers[job.schedulerIndex];
+                SimulationConfig config = jobConfig(job);
+                if (replication.enabled()) {
+                    ReplicatedStatistics r = replicate(replication, seed, job.stream, [&](RandomStream& rng) {
+                        return simulate(backend, sched.scheduler, config, rng);
+                    });
+                    job.statistics = r.mean;
+                    job.halfWidth = r.halfWidth;
+                    job.replications = r.replications;
+                } else {
+                    RandomStream rng(seed, job.stream);
+                    job.statistics = simulate(backend, sched.scheduler, config, rng);
                 }
-
-                // Assign front of ready queue to CPU, schedule tentative departure, and update last time assigned CPU
-                onCpu = readyQueue.getFront();
-                eventQueue.scheduleEvent(clock + onCpu->getServiceTimeLeft(), onCpu, DEPARTURE);
-                onCpu->setLastTimeAssignedCpu(clock);
-            }
-            // Schedule next timeout event
-            eventQueue.scheduleEvent(clock + quantumLength, nullptr, TIMEOUT);
+                job.wallTime = duration<double>(steady_clock::now() - start).count();
+                reportProgress();
+            });
         }
-        // If event is a query (updating statistics)
-        else if (current.getType() == QUERY) {
-            // Update statistics
-            totalInReadyQueue += readyQueue.size();
-            // Schedule next query event
-            eventQueue.scheduleEvent(clock + queryInterval, nullptr, QUERY);
+    }
+    pool.wait();
+    cout << "\rSimulating on " << pool.size() << " threads...done" << endl;
+
+    // Cache the new results
+    if (cache != nullptr) {
+        for (size_t n = 0; n < results; n++) {
+            if (!missing[n]) continue;
+            CachedResult result {};
+            result.key = keys[n];
+            if (commonRandomNumbers) {
+                result.replications = 1;
+                result.wallTime = replicationWallTimes[n];
+                CachedResult::storeScalars(replicationStatistics[n], result.statistics);
+            } else {
+                result.replications = jobs[n].replications;
+                result.wallTime = jobs[n].wallTime;
+                CachedResult::storeScalars(jobs[n].statistics, result.statistics);
+                CachedResult::storeScalars(jobs[n].halfWidth, result.halfWidths);
+            }
+            cache->add(result);
         }
+        cache->save();
+        cout << "Took " << cached << "/" << results << " results from the cache" << endl;
     }
 
-    // Sum turnaround times for calculating average turnaround time
-    double totalTurnaroundTime = 0;
-    for (auto process : processes) {
-        if (process->getCompletionTime() == -1) continue;
-        double turnaround = process->getCompletionTime() - process->getArrivalTime();
-        totalTurnaroundTime += turnaround;
+    // Summarize the replications with common random numbers, pairing each scheduler's with the first scheduler's
+    vector<ReplicatedStatistics> differences(commonRandomNumbers ? jobs.size() : 0);
+    if (commonRandomNumbers) {
+        for (size_t k = 0; k < jobs.size(); k++) {
+            SweepJob& job = jobs[k];
+            size_t first = k % arrivalRates.size();
+            ReplicationSample sample, difference;
+            for (unsigned r = 0; r < commonReplications; r++) {
+                const Statistics& s = replicationStatistics[k * commonReplications + r];
+                sample.add(s);
+                difference.add(scalarDifference(s, replicationStatistics[first * commonReplications + r]));
+                job.wallTime += replicationWallTimes[k * commonReplications + r];
+            }
+            ReplicatedStatistics r = sample.summarize(replication.confidence);
+            job.statistics = r.mean;
+            job.halfWidth = r.halfWidth;
+            job.replications = r.replications;
+            differences[k] = difference.summarize(replication.confidence);
+        }
     }
 
-    // Calculate statistics
-    double avgTurnaroundTime = totalTurnaroundTime / numProcesses;
-    double throughput = processesSimulated / clock;
-    double avgCpuUtil = 1 - (cpuIdleTime / clock);
-    double avgReadyQueueSize = (double) totalInReadyQueue / (clock / queryInterval);
+    // Save each scheduler's statistics for each arrival rate in CSV format (jobs are already in order)
+    ofstream csvOut, differencesOut;
+    ofstream timingsOut("timings.csv");
+    for (size_t i = 0; i < schedulers.size(); i++) {
+        double totalTime = 0, slowestTime = 0, slowestRate = 0;
+        unsigned totalReplications = 0, significantRates = 0;
+        bool compared = commonRandomNumbers && i > 0;
+        csvOut.open(schedulers[i].name + ".csv");
+        if (compared)
+            differencesOut.open(schedulers[i].name + "-" + schedulers[0].name + ".csv");
+        for (size_t k = 0; k < jobs.size(); k++) {
+            SweepJob& job = jobs[k];
+            if (job.schedulerIndex != i) continue;
+            vector<double> values = csvValues(job.statistics);
+            csvOut << job.arrivalRate;
+            for (double value : values)
+                csvOut << "," << value;
+            if (replicated) {
+                // The confidence bounds of each value above, in the same order
+                vector<double> halfWidths = csvValues(job.halfWidth);
+                csvOut << "," << job.replications;
+                for (size_t v = 0; v < values.size(); v++)
+                    csvOut << "," << values[v] - halfWidths[v] << "," << values[v] + halfWidths[v];
+            }
+            csvOut << "\n";
+            if (compared) {
+                // Each paired difference with its confidence bounds
+                vector<double> means = csvValues(differences[k].mean);
+                vector<double> halfWidths = csvValues(differences[k].halfWidth);
+                differencesOut << job.arrivalRate << "," << job.replications;
+                for (size_t v = 0; v < means.size(); v++)
+                    differencesOut << "," << means[v] << "," << means[v] - halfWidths[v] << ","
+                                   << means[v] + halfWidths[v];
+                differencesOut << "\n";
+                if (std::fabs(means[0]) > halfWidths[0])
+                    significantRates++;
+            }
+            timingsOut << schedulers[i].name << "," << job.arrivalRate << "," << job.wallTime << "\n";
+
+            totalTime += job.wallTime;
+            totalReplications += job.replications;
+            if (job.wallTime > slowestTime) {
+                slowestTime = job.wallTime;
+                slowestRate = job.arrivalRate;
+            }
+        }
+        csvOut.close();
+        if (compared)
+            differencesOut.close();
+        printf("%10s: %8.3f s total, slowest %7.3f s (arrival rate %g)", schedulers[i].name.c_str(), totalTime,
+               slowestTime, slowestRate);
+        if (replicated)
+            printf(", %u replications", totalReplications);
+        if (compared)
+            printf(", turnaround differs from %s at %u/%zu rates", schedulers[0].name.c_str(), significantRates,
+                   arrivalRates.size());
+        printf("\n");
+    }
 
-    // return statistics
-    return {avgTurnaroundTime, throughput, avgCpuUtil, avgReadyQueueSize};
+    cout << "Finished all simulations." << endl;
 }
 
 /**
- * Runs all the simulations specified in the assignment for different arrival rates and saves their statistics
- * in a CSV file for easy importing into a spreadsheet for graph creation.
+ * Parses a command line argument that must be a number and nothing else.
+ * @param text The argument.
+ * @param name What the argument is, for the error message.
+ * @return The number (the job it's part of is checked to be valid by validateJob()).
+ * @throws runtime_error If the argument isn't a number.
  */
-void runAllSimulations() {
-
-    // Vector of average arrival rates and average service time run simulations with
-    vector<double> arrivalRates (30);
-    iota(arrivalRates.begin(), arrivalRates.end(), 1);
-    double serviceTime = 0.06;
-
-    // Number of processes to simulate (higher = more accurate statistics)
-    // and query interval (lower = more accurate statistics)
-    int numProcesses = 10000;
-    double queryInterval = 0.01;
-
-    Statistics s {};
-    ofstream csvOut;
-
-    // Simulate various algorithms and save their statistics for each arrival rate in CSV format
-    // First Come First Serve (FCFS)
-    csvOut.open("FCFS.csv");
-    for (double arrivalRate : arrivalRates) {
-        cout << "\rSimulating FCFS..." << arrivalRate << "/" << arrivalRates[arrivalRates.size() - 1] << std::flush;
-        s = simulatePriorityBased<FCFSPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                                       queryInterval, false, false);
-        csvOut << arrivalRate << "," << s.avgTurnaroundTime << "," << s.throughput << "," << s.avgCpuUtil
-               << "," << s.avgReadyQueueSize << endl;
-    }
-    csvOut.close();
-    cout << "\rSimulating FCFS...done" << endl;
-
-    // Shortest Remaining Time First (SRTF)
-    csvOut.open("SRTF.csv");
-    for (double arrivalRate : arrivalRates) {
-        cout << "\rSimulating SRTF..." << arrivalRate << "/" << arrivalRates[arrivalRates.size() - 1] << std::flush;
-        s = simulatePriorityBased<SRTFPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                          queryInterval, true, false);
-        csvOut << arrivalRate << "," << s.avgTurnaroundTime << "," << s.throughput << "," << s.avgCpuUtil
-               << "," << s.avgReadyQueueSize << endl;
-    }
-    csvOut.close();
-    cout << "\rSimulating SRTF...done" << endl;
-
-    // Highest Response Ratio Next (HRRN)
-    csvOut.open("HRRN.csv");
-    for (double arrivalRate : arrivalRates) {
-        cout << "\rSimulating HRRN..." << arrivalRate << "/" << arrivalRates[arrivalRates.size() - 1] << std::flush;
-        s = simulatePriorityBased<HRRNPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                          queryInterval, false, true);
-        csvOut << arrivalRate << "," << s.avgTurnaroundTime << "," << s.throughput << "," << s.avgCpuUtil
-               << "," << s.avgReadyQueueSize << endl;
-    }
-    csvOut.close();
-    cout << "\rSimulating HRRN...done" << endl;
+double parseReal(const char* text, const string& name) {
+    char* end;
+    double value = strtod(text, &end);
+    if (end == text || *end != '\0')
+        throw runtime_error("Invalid " + name + " \"" + text + "\". Must be a number");
+    return value;
+}
 
-    // Round Robin (RR)
-    double quantums[] {0.01, 0.2};
-    for (auto quantum : quantums) {
-        csvOut.open("RR(" + to_string(quantum) + ").csv");
-        for (double arrivalRate : arrivalRates) {
-            cout << "\rSimulating RR(" << quantum << ")..." << arrivalRate << "/" << arrivalRates[arrivalRates.size() - 1] << std::flush;
-            s = simulatePriorityBased<FCFSPriorityComparator>(numProcesses, arrivalRate, serviceTime, quantum,
-                                                              queryInterval, false, false);
-            csvOut << arrivalRate << "," << s.avgTurnaroundTime << "," << s.throughput << "," << s.avgCpuUtil
-                   << "," << s.avgReadyQueueSize << endl;
-        }
-        csvOut.close();
-        cout << "\rSimulating RR(" << quantum << ")...done" << endl;
+/**
+ * Parses a command line argument that must be an integer within a range and nothing else.
+ * @tparam Integer The type of the integer.
+ * @param text The argument.
+ * @param name What the argument is, for the error message.
+ * @param min The smallest value allowed.
+ * @param max The largest value allowed.
+ * @return The integer.
+ * @throws runtime_error If the argument isn't an integer, or is out of range.
+ */
+template <class Integer>
+Integer parseInteger(const char* text, const string& name, Integer min, Integer max) {
+    // Only a digit, or a minus sign for a signed integer, may start it (strtoull would wrap a negative number around)
+    bool valid = isdigit((unsigned char) text[0]) || (std::is_signed<Integer>::value && text[0] == '-');
+    char* end = nullptr;
+    errno = 0;
+    Integer value = 0;
+    if constexpr (std::is_signed<Integer>::value) {
+        long long parsed = strtoll(text, &end, 10);
+        valid = valid && parsed >= (long long) min && parsed <= (long long) max;
+        value = (Integer) parsed;
+    } else {
+        unsigned long long parsed = strtoull(text, &end, 10);
+        valid = valid && parsed >= (unsigned long long) min && parsed <= (unsigned long long) max;
+        value = (Integer) parsed;
     }
-
-    cout << "Finished all simulations." << endl;
+    if (!valid || end == text || *end != '\0' || errno == ERANGE)
+        throw runtime_error("Invalid " + name + " \"" + text + "\". Must be an integer between " + to_string(min)
+                            + " and " + to_string(max));
+    return value;
 }
 
 /**
  * Parses command line input and runs a scheduling simulations.
  * To run a simulation, specify the scheduler, arrival rate, service time, and quantum length:
  *   <sched> <arrival_rate> <service_time> <quantum_length>
- * The quantum length will be ignored unless the round robin scheduler is being simulated.
+ * The quantum length will be ignored unless a time sliced scheduler (RR, MLFQ or CFS) is being simulated.
+ * Optionally, "--seed <seed>" can be given anywhere on the command line to make the run reproducible, and
+ * "--lazy-cancel" makes the event queue tombstone cancelled departures instead of removing them right away.
+ * "--queue <set|heap|calendar>" picks the event queue implementation (set by default), and "--threads <n>" sets the
+ * number of threads used to run all algorithms (one per hardware thread by default).
+ * "--query-interval <seconds>" sets how often the ready queue size is sampled (0.01 by default); 0 integrates the ready
+ * queue size and CPU utilization exactly at every event instead.
+ * "--cores <n>" simulates n CPU cores sharing one ready queue (1 by default), and "--per-core-queues" gives each core
+ * its own ready queue, with idle cores stealing work from the longest queue.
+ * "--trace <file>" replays the processes of a binary trace file instead of generating them, in which case only the
+ * scheduler and quantum length are given: <sched> <quantum_length>. The whole trace is replayed unless
+ * "--processes <n>" limits the number of processes (which is 10000 for generated processes). A text trace of
+ * "<arrival>,<service>" lines is converted to a binary trace once with "--import-trace <csv_file> <trace_file>".
+ * "--clusters <n>" simulates n clusters (each with the given number of cores) fed by a dispatcher, on the parallel
+ * engine, which runs the clusters on "--threads <n>" threads. "--dispatch-delay <seconds>" sets the time a process
+ * takes to reach its cluster (0 by default), and "--routing <round-robin|least-loaded>" how the dispatcher picks it
+ * (round robin by default; least loaded needs a dispatch delay).
+ * MLFQ has "--levels <n>" priority levels (3 by default) whose quanta double from the quantum length, unless
+ * "--level-quanta <q0,q1,...>" gives the (positive) quantum of each level.
+ * "--boost-interval <seconds>" sets how often every process is boosted to the top level (1 by default, 0 never).
+ * CFS shares "--target-latency <seconds>" (8 quantum lengths by default) among the runnable processes, giving each a
+ * slice no shorter than the quantum length.
+ * "--replications <n>" runs n independent replications of every simulation and reports confidence intervals
+ * ("--confidence <level>", 0.95 by default) for the statistics. "--precision <fraction>" keeps adding replications
+ * until the confidence interval of the average turnaround time is within that fraction of the average (or
+ * "--max-replications <n>" are run, 100 by default), after at least 5 replications (or n).
+ * "--warmup" detects the end of the warm-up of every simulation and deletes it from the statistics, then simulates the
+ * number of processes on top of it.
+ * "--common-random-numbers" makes a sweep simulate every scheduler on the same processes, and save the differences of
+ * each from FCFS with their confidence intervals (over "--replications <n>", 10 by default).
+ * "--cache <file>" keeps the results of a sweep in a result cache file, so running the sweep again (with the same
+ * "--seed <seed>") only simulates what isn't in it yet.
+ * "--event-log <file>" writes every arrival, dispatch, preemption and departure of a single run to a binary event log,
+ * which the eventlog tool exports to CSV.
+ * "--checkpoint <file>" saves the whole state of a single run to a checkpoint file when it ends, or with
+ * "--checkpoint-at <seconds>" at that simulated time, and "--resume <file>" carries on from a checkpoint instead of
+ * starting empty, possibly with different scheduler parameters (quantum length, levels, boost interval, target
+ * latency...). "--reset-statistics" forgets the statistics gathered before the checkpoint, as if they were a deleted
+ * warm-up, so forks of a warmed-up state only measure what happens after it.
+ * "--serve" runs jobs read as newline-delimited JSON from standard input (see JobJson.h) on "--threads <n>" threads,
+ * streaming their results to standard output as they finish, and "--socket <path>" serves them on a Unix domain socket.
+ * Served jobs may only name traces and checkpoints by file name within "--job-dir <dir>", and no files without it.
  * Available schedulers are:
  *   (-1) Run all algorithms and save results to CSV
  *    (1) First Come First Serve (FCFS)
  *    (2) Shortest Remaining Time First (SRTF)
  *    (3) Highest Response Ratio Next (HRRN)
  *    (4) Round Robin (RR)
+ *    (5) Multi-Level Feedback Queue (MLFQ)
+ *    (6) Completely Fair Scheduler (CFS)
  */
 int main(int argc, char* argv[]) {
 
-    // Number of processes to simulate (higher = more accurate statistics)
-    // and query interval (lower = more accurate statistics)
-    int numProcesses = 10000;
-    double queryInterval = 0.01;
+    // Simulation parameters (number of processes, query interval, etc. as in SimulationConfig unless given)
+    SimulationConfig config;
+
+    // Seed for the random stream (non-deterministic unless given with --seed)
+    unsigned long seed = RandomStream::randomSeed();
+    bool seedGiven = false;
+    EventQueueBackend backend = SET_QUEUE;
+    unsigned numThreads = 0;
+    // Text trace to convert and binary trace to write, and whether the number of processes was given
+    string importCsvPath, importTracePath;
+    bool numProcessesGiven = false;
+    // Parameters of the cluster model, and whether any were given (which runs the cluster model)
+    ClusterConfig cluster;
+    bool clusterModel = false;
+    // Number of replications to run
+    ReplicationConfig replication;
+    // Whether a sweep simulates every scheduler on the same processes
+    bool commonRandomNumbers = false;
+    // The result cache of a sweep (empty for none)
+    string cachePath;
+    // Whether to serve jobs from standard input, and the Unix domain socket to serve them on (empty for none)
+    bool serve = false;
+    string socketPath;
+    // The directory served jobs may name files in (empty if they may name none)
+    string jobDirectory;
+
+    // Parse options, removing them from the arguments so only positional arguments remain
+    int positional = 1;
+    try {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                seed = parseInteger<unsigned long>(argv[++i], "seed", 0, ULONG_MAX);
+                seedGiven = true;
+            }
+            else if (strcmp(argv[i], "--lazy-cancel") == 0)
+                config.lazyCancellation = true;
+            else if (strcmp(argv[i], "--query-interval") == 0 && i + 1 < argc)
+                config.queryInterval = parseReal(argv[++i], "query interval");
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                numThreads = parseInteger<unsigned>(argv[++i], "number of threads", 0, UINT_MAX);
+            else if (strcmp(argv[i], "--cores") == 0 && i + 1 < argc)
+                config.numCores = parseInteger<unsigned>(argv[++i], "number of cores", 1, 65535);
+            else if (strcmp(argv[i], "--per-core-queues") == 0)
+                config.perCoreQueues = true;
+            else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+                config.tracePath = argv[++i];
+            else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc) {
+                config.numProcesses = parseInteger<int>(argv[++i], "number of processes", 1, INT_MAX);
+                numProcessesGiven = true;
+            }
+            else if (strcmp(argv[i], "--import-trace") == 0 && i + 2 < argc) {
+                importCsvPath = argv[++i];
+                importTracePath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--clusters") == 0 && i + 1 < argc) {
+                cluster.numClusters = parseInteger<unsigned>(argv[++i], "number of clusters", 1, 65535);
+                clusterModel = true;
+            }
+            else if (strcmp(argv[i], "--dispatch-delay") == 0 && i + 1 < argc) {
+                cluster.dispatchDelay = parseReal(argv[++i], "dispatch delay");
+                clusterModel = true;
+            }
+            else if (strcmp(argv[i], "--routing") == 0 && i + 1 < argc) {
+                string name = argv[++i];
+                clusterModel = true;
+                if (name == "round-robin")
+                    cluster.routing = ROUND_ROBIN_ROUTING;
+                else if (name == "least-loaded")
+                    cluster.routing = LEAST_LOADED_ROUTING;
+                else {
+                    cerr << "Invalid routing \"" << name << "\". Available choices: round-robin, least-loaded" << endl;
+                    return 1;
+                }
+            }
+            else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc)
+                config.feedbackLevels = parseInteger<unsigned>(argv[++i], "number of levels", 1, 64);
+            else if (strcmp(argv[i], "--level-quanta") == 0 && i + 1 < argc) {
+                string quanta = argv[++i];
+                config.levelQuanta.clear();
+                for (size_t start = 0; start <= quanta.size();) {
+                    size_t end = quanta.find(',', start);
+                    if (end == string::npos) end = quanta.size();
+                    config.levelQuanta.push_back(parseReal(quanta.substr(start, end - start).c_str(), "level quantum"));
+                    start = end + 1;
+                }
+            }
+            else if (strcmp(argv[i], "--boost-interval") == 0 && i + 1 < argc)
+                config.boostInterval = parseReal(argv[++i], "boost interval");
+            else if (strcmp(argv[i], "--target-latency") == 0 && i + 1 < argc)
+                config.targetLatency = parseReal(argv[++i], "target latency");
+            else if (strcmp(argv[i], "--replications") == 0 && i + 1 < argc)
+                replication.minReplications = parseInteger<unsigned>(argv[++i], "number of replications", 1,
+                                                                     UINT_MAX);
+            else if (strcmp(argv[i], "--max-replications") == 0 && i + 1 < argc)
+                replication.maxReplications = parseInteger<unsigned>(argv[++i], "maximum number of replications", 1,
+                                                                   UINT_MAX);
+            else if (strcmp(argv[i], "--precision") == 0 && i + 1 < argc)
+                replication.precision = parseReal(argv[++i], "precision");
+            else if (strcmp(argv[i], "--confidence") == 0 && i + 1 < argc)
+                replication.confidence = parseReal(argv[++i], "confidence level");
+            else if (strcmp(argv[i], "--warmup") == 0)
+                config.deleteWarmup = true;
+            else if (strcmp(argv[i], "--common-random-numbers") == 0)
+                commonRandomNumbers = true;
+            else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+                cachePath = argv[++i];
+            else if (strcmp(argv[i], "--event-log") == 0 && i + 1 < argc)
+                config.eventLogPath = argv[++i];
+            else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+                config.checkpointPath = argv[++i];
+            else if (strcmp(argv[i], "--checkpoint-at") == 0 && i + 1 < argc)
+                config.checkpointTime = parseReal(argv[++i], "checkpoint time");
+            else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc)
+                config.resumePath = argv[++i];
+            else if (strcmp(argv[i], "--reset-statistics") == 0)
+                config.resetStatistics = true;
+            else if (strcmp(argv[i], "--serve") == 0)
+                serve = true;
+            else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc)
+                socketPath = argv[++i];
+            else if (strcmp(argv[i], "--job-dir") == 0 && i + 1 < argc)
+                jobDirectory = argv[++i];
+            else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+                string name = argv[++i];
+                if (name == "set")
+                    backend = SET_QUEUE;
+                else if (name == "heap")
+                    backend = HEAP_QUEUE;
+                else if (name == "calendar")
+                    backend = CALENDAR_QUEUE;
+                else {
+                    cerr << "Invalid event queue \"" << name << "\". Available choices: set, heap, calendar" << endl;
+                    return 1;
+                }
+            }
+            else
+                argv[positional++] = argv[i];
+        }
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    argc = positional;
+
+    // Convert a text trace and stop
+    if (!importCsvPath.empty()) {
+        try {
+            size_t count = TraceFile::importCsv(importCsvPath, importTracePath);
+            cout << "Wrote " << count << " processes to " << importTracePath << endl;
+            return 0;
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    // Serve jobs until the input ends (or forever, on a socket)
+    if (serve || !socketPath.empty()) {
+        try {
+            JobServer server(numThreads, jobDirectory);
+            if (!socketPath.empty())
+                server.serveSocket(socketPath);
+            return server.serveStream(STDIN_FILENO, STDOUT_FILENO) ? 0 : 1;
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
 
-    // Variables for input parameters
-    int scheduler, arrivalRate;
-    double serviceTime, quantumLength;
+    // Replay the whole trace unless told otherwise
+    bool replayTrace = !config.tracePath.empty();
+    if (replayTrace && !numProcessesGiven)
+        config.numProcesses = INT_MAX;
+
+    cluster.numThreads = numThreads;
+    JobSpec job;
+    job.config = config;
+    job.backend = backend;
+    job.seed = seed;
+    job.clusterModel = clusterModel;
+    job.cluster = cluster;
+    job.replication = replication;
 
     // Parse command line input
-    if (argc >= 2 && stoi(argv[1]) == -1) {
-        runAllSimulations();
+    bool sweep = false, singleRun = false;
+    try {
+        sweep = argc >= 2 && parseInteger<int>(argv[1], "scheduler", -1, 6) == -1;
+        singleRun = !sweep && (argc == 4 + 1 || (replayTrace && argc == 2 + 1));
+        if (singleRun) {
+            job.scheduler = parseInteger<int>(argv[1], "scheduler", -1, 6);
+            if (argc == 4 + 1) {
+                job.config.arrivalRate = parseReal(argv[2], "arrival rate");
+                job.config.serviceTime = parseReal(argv[3], "service time");
+                job.config.quantumLength = parseReal(argv[4], "quantum length");
+            } else {
+                job.config.quantumLength = parseReal(argv[2], "quantum length");
+            }
+        }
+        validateJob(job);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    if (sweep) {
+        if (replayTrace) {
+            cerr << "A trace can't be replayed with varying arrival rates, run one scheduler at a time instead" << endl;
+            return 1;
+        }
+        if (clusterModel) {
+            cerr << "Clusters are simulated one scheduler at a time" << endl;
+            return 1;
+        }
+        if (!config.eventLogPath.empty()) {
+            cerr << "An event log records a single simulation, run one scheduler at a time instead" << endl;
+            return 1;
+        }
+        if (!config.checkpointPath.empty() || !config.resumePath.empty()) {
+            cerr << "A checkpoint holds a single simulation, run one scheduler at a time instead" << endl;
+            return 1;
+        }
+        if (commonRandomNumbers && replication.precision > 0) {
+            cerr << "Common random numbers pair every scheduler's replications, so they need a fixed number of "
+                    "replications rather than a precision" << endl;
+            return 1;
+        }
+        if (!cachePath.empty() && !seedGiven) {
+            cerr << "Cached results are only found again under the same seed, give one with --seed" << endl;
+            return 1;
+        }
+        try {
+            unique_ptr<ResultCache> cache;
+            if (!cachePath.empty())
+                cache.reset(new ResultCache(cachePath));
+            runAllSimulations(seed, backend, numThreads, config, replication, commonRandomNumbers, cache.get());
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
         return 0;
-    } else if (argc == 4 + 1) {
-
-        scheduler = stoi(argv[1]);
-        arrivalRate = stoi(argv[2]);
-        serviceTime = stod(argv[3]);
-        quantumLength = stod(argv[4]);
-
-        Statistics s {};
-
-        switch (scheduler) {
-            case 1:
-                s = simulatePriorityBased<FCFSPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                                  queryInterval, false, false);
-                break;
-            case 2:
-                s = simulatePriorityBased<SRTFPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                                  queryInterval, true, false);
-                break;
-            case 3:
-                s = simulatePriorityBased<HRRNPriorityComparator>(numProcesses, arrivalRate, serviceTime, 0,
-                                                                  queryInterval, false, true);
-                break;
-            case 4:
-                s = simulatePriorityBased<FCFSPriorityComparator>(numProcesses, arrivalRate, serviceTime, quantumLength,
-                                                                  queryInterval, false, false);
-                break;
-            default:
-                std::cerr << "Invalid scheduler choice. Available choices:\n"
-                             "(-1) Run all algorithms and save results to CSV\n"
-                             " (1) First Come First Serve (FCFS)\n"
-                             " (2) Shortest Remaining Time First (SRTF)\n"
-                             " (3) Highest Response Ratio Next\n"
-                             " (4) Round Robin (RR)" << endl;
-                return 1;
+    } else if (singleRun) {
+
+        if (commonRandomNumbers) {
+            cerr << "Common random numbers compare the schedulers of a sweep, run all algorithms (-1) instead" << endl;
+            return 1;
+        }
+        if (!cachePath.empty()) {
+            cerr << "Only the results of a sweep are cached, run all algorithms (-1) instead" << endl;
+            return 1;
+        }
+        if (job.scheduler < 1 || job.scheduler > 6) {
+            std::cerr << "Invalid scheduler choice. Available choices:\n"
+                         "(-1) Run all algorithms and save results to CSV\n"
+                         " (1) First Come First Serve (FCFS)\n"
+                         " (2) Shortest Remaining Time First (SRTF)\n"
+                         " (3) Highest Response Ratio Next\n"
+                         " (4) Round Robin (RR)\n"
+                         " (5) Multi-Level Feedback Queue (MLFQ)\n"
+                         " (6) Completely Fair Scheduler (CFS)" << endl;
+            return 1;
         }
 
-        s.display();
+        try {
+            // Replicate if asked (the first replication is the same as an unreplicated run)
+            if (replication.enabled()) {
+                ReplicatedStatistics r = replicateJob(job);
+                r.display();
+                return 0;
+            }
+            Statistics s = runJob(job);
+            s.display();
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
 
         return 0;
 
     } else {
-        std::cerr << "Invalid number of arguments. Usage: \"<sched> <arrival_rate> <service_time> <quantum_length>\".\n"
+        std::cerr << "Invalid number of arguments. Usage: \"<sched> <arrival_rate> <service_time> <quantum_length> "
+                     "[--seed <seed>] [--lazy-cancel] [--queue <set|heap|calendar>] [--threads <n>] "
+                     "[--query-interval <seconds>] [--cores <n>] [--per-core-queues] [--clusters <n>] "
+                     "[--dispatch-delay <seconds>] [--routing <round-robin|least-loaded>] [--levels <n>] "
+                     "[--level-quanta <q0,q1,...>] [--boost-interval <seconds>] [--target-latency <seconds>] "
+                     "[--replications <n>] [--precision <fraction>] [--max-replications <n>] "
+                     "[--confidence <level>] [--warmup] [--common-random-numbers] [--cache <file>] "
+                     "[--event-log <file>] [--checkpoint <file>] [--checkpoint-at <seconds>] [--resume <file>] "
+                     "[--reset-statistics]\"\n"
+                     "   or: \"--serve [--threads <n>] [--job-dir <dir>]\" or \"--socket <path> [--threads <n>] "
+                     "[--job-dir <dir>]\" to run JSON jobs.\n"
+                     "   or: \"<sched> <quantum_length> --trace <trace_file> [--processes <n>] [options]\"\n"
+                     "   or: \"--import-trace <csv_file> <trace_file>\".\n"
                      "Use sched=-1 to run all algorithms with varying arrival rates and save results to CSV." << endl;
     }
 
@@ -0,0 +1,109 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include "schedsim.h"
+#include "JobJson.h"
+
+using std::string;
+
+/**
+ * Copies the scalar statistics of a simulation into the C struct.
+ * @param s The statistics.
+ * @param out The C struct.
+ */
+static void copyStatistics(const Statistics& s, schedsim_statistics* out) {
+    out->avg_turnaround_time = s.avgTurnaroundTime;
+    out->throughput = s.throughput;
+    out->avg_cpu_util = s.avgCpuUtil;
+    out->avg_ready_queue_size = s.avgReadyQueueSize;
+    out->turnaround_time_std_dev = s.turnaroundTimeStdDev;
+    out->min_turnaround_time = s.minTurnaroundTime;
+    out->max_turnaround_time = s.maxTurnaroundTime;
+    out->avg_waiting_time = s.avgWaitingTime;
+    for (int i = 0; i < NUM_STATISTICS_QUANTILES; i++) {
+        out->turnaround_time_quantiles[i] = s.turnaroundTimeQuantiles[i];
+        out->waiting_time_quantiles[i] = s.waitingTimeQuantiles[i];
+    }
+}
+
+/**
+ * Copies an error message into a caller's buffer, truncating it to fit.
+ * @param message The message.
+ * @param error The buffer (may be NULL).
+ * @param errorSize The size of the buffer.
+ */
+static void copyError(const char* message, char* error, size_t errorSize) {
+    if (error == nullptr || errorSize == 0) return;
+    size_t n = std::min(strlen(message), errorSize - 1);
+    memcpy(error, message, n);
+    error[n] = '\0';
+}
+
+extern "C" int schedsim_abi_version(void) {
+    return SCHEDSIM_ABI_VERSION;
+}
+
+extern "C" int schedsim_run(const char* job_json, schedsim_result* result, char* error, size_t error_size) {
+    try {
+        if (job_json == nullptr || result == nullptr)
+            throw runtime_error("The job and result can't be NULL");
+        size_t size = result->struct_size;
+        if (size < sizeof(size_t))
+            throw runtime_error("The result's struct_size must be set to sizeof(schedsim_result)");
+        JobSpec job = parseJobSpec(JsonParser::parse(job_json));
+        validateJob(job);
+
+        auto start = std::chrono::steady_clock::now();
+        ReplicatedStatistics r = simulateJob(job);
+
+        schedsim_result full {};
+        full.struct_size = size;
+        full.seed = job.seed;
+        full.replications = r.replications;
+        full.converged = r.converged;
+        copyStatistics(r.mean, &full.statistics);
+        copyStatistics(r.halfWidth, &full.half_widths);
+        full.num_cores = (unsigned) r.mean.coreUtilization.size();
+        full.migrations = r.mean.migrations;
+        full.warmup_processes = r.mean.warmupProcesses;
+        full.warmup_time = r.mean.warmupTime;
+        full.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Copy only as much as the caller's struct holds, zeroing any fields this library doesn't know of
+        memcpy(result, &full, std::min(size, sizeof(full)));
+        if (size > sizeof(full))
+            memset(reinterpret_cast<char*>(result) + sizeof(full), 0, size - sizeof(full));
+        return 0;
+    } catch (const std::exception& e) {
+        copyError(e.what(), error, error_size);
+        return -1;
+    } catch (...) {
+        copyError("Unknown error", error, error_size);
+        return -1;
+    }
+}
+
+extern "C" char* schedsim_run_json(const char* job_json) {
+    try {
+        string result = runJsonJob(job_json == nullptr ? "" : job_json);
+        char* s = static_cast<char*>(malloc(result.size() + 1));
+        if (s != nullptr)
+            memcpy(s, result.c_str(), result.size() + 1);
+        return s;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+extern "C" void schedsim_free(char* s) {
+    free(s);
+}
@@ -0,0 +1,98 @@
+/**
+ * @author zachstence / zms22
+ * @since 3/29/2019
+ */
+
+#ifndef CS4328_PROJECT1_SCHEDSIM_H
+#define CS4328_PROJECT1_SCHEDSIM_H
+
+#include <stddef.h>
+
+/*
+ * The C interface of the simulator, for calling it in-process from C and from any language with a C foreign function
+ * interface. Build it as a shared library with
+ *   g++ -std=c++17 -O2 -fPIC -shared -pthread schedsim.cpp -o libschedsim.so
+ * Jobs are given as JSON objects, exactly as in the server mode (see JobJson.h), so new options never change the
+ * interface. Every function is thread safe, and jobs run in the calling thread, so callers can run as many at once as
+ * they have threads. Results are allocated by the caller, who gives their size in struct_size, so the library never
+ * writes past the end of a result built against an older header, and zeroes the fields it doesn't know of itself.
+ */
+
+#define SCHEDSIM_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The scalar statistics of a simulation, in the order of Statistics::forEachScalar(). Times are in seconds.
+ */
+typedef struct schedsim_statistics {
+    double avg_turnaround_time;
+    double throughput;
+    double avg_cpu_util;
+    double avg_ready_queue_size;
+    double turnaround_time_std_dev;
+    double min_turnaround_time;
+    double max_turnaround_time;
+    double avg_waiting_time;
+    // p50, p95, p99 and p99.9
+    double turnaround_time_quantiles[4];
+    double waiting_time_quantiles[4];
+} schedsim_statistics;
+
+/**
+ * The result of a job: its statistics (averaged over the replications, if replicated) and the half-widths of their
+ * confidence intervals (all 0 unless replicated). The caller sets struct_size to sizeof(schedsim_result) before
+ * passing it to schedsim_run().
+ */
+typedef struct schedsim_result {
+    size_t struct_size;
+    unsigned long seed;
+    unsigned replications;
+    int converged;
+    schedsim_statistics statistics;
+    schedsim_statistics half_widths;
+    unsigned num_cores;
+    unsigned long migrations;
+    int warmup_processes;
+    double warmup_time;
+    double wall_time;
+} schedsim_result;
+
+/**
+ * Returns the version of the interface the library was built with, to be checked against SCHEDSIM_ABI_VERSION.
+ * @return The version.
+ */
+int schedsim_abi_version(void);
+
+/**
+ * Runs a job.
+ * @param job_json The job, a JSON object.
+ * @param result Set to the result of the job, if it ran, up to its struct_size (which is left as it is).
+ * @param error Set to the error message (truncated to error_size, and always terminated) if the job couldn't be run.
+ * May be NULL.
+ * @param error_size The size of the error buffer.
+ * @return 0 if the job ran, -1 otherwise (including when result->struct_size is too small to hold struct_size).
+ */
+int schedsim_run(const char* job_json, schedsim_result* result, char* error, size_t error_size);
+
+/**
+ * Runs a job and returns its result as JSON, exactly as the server mode would.
+ * @param job_json The job, a JSON object.
+ * @return The result (or error) as one line of JSON, to be freed with schedsim_free(). NULL only if out of memory.
+ */
+char* schedsim_run_json(const char* job_json);
+
+/**
+ * Frees a string returned by the library.
+ * @param s The string (may be NULL).
+ */
+void schedsim_free(char* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif //CS4328_PROJECT1_SCHEDSIM_H